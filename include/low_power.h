@@ -0,0 +1,20 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Battery operating mode (DeviceConfig::lowPower). Instead of the always-on
+// loop, the device sleeps between samples, keeps readings compressed in RTC
+// memory and only connects Wi-Fi/MQTT every flushIntervalMs to publish the
+// batch and pick up config changes from MQTT_TOPIC_CONFIG.
+
+// Call from setup() after initRestApi() and before any network setup.
+// Restores the config snapshot kept in RTC_NOINIT memory when waking from
+// deep sleep or after the software restart that leaves low-power mode (other
+// resets start from the defaults). Returns true if the device woke from
+// low-power deep sleep; setup() should then return without connecting so
+// loop() can continue the duty cycle.
+bool lowPowerResume();
+
+// Run one duty cycle from loop(): sample if due, upload the batch if due,
+// then sleep until the next sample. Does not return when deep sleep is used.
+void lowPowerLoop();
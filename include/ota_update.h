@@ -0,0 +1,25 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Over-the-air firmware updates. Patches produced by tools/ota_patch.cpp (full
+// LZ-compressed images or deltas against the running firmware) are streamed
+// straight into the inactive OTA partition; the image is only marked bootable
+// after its SHA-256 matches the one recorded in the patch header.
+
+// Schedule a download of the patch at url (plain http://). The transfer runs
+// from otaLoop() so callers such as the REST handler can return immediately.
+void requestHttpOta(const char* url);
+
+// Call regularly from loop(). Runs a scheduled HTTP update; on success the
+// device reboots into the new firmware.
+void otaLoop();
+
+// Feed an MQTT message to the OTA receiver. Returns true if the topic was
+// MQTT_TOPIC_OTA (the message is consumed), false otherwise.
+// Payload: 4-byte little-endian offset into the patch followed by the data;
+// offset 0 starts a new transfer. Progress is reported on MQTT_TOPIC_OTA_STATUS.
+bool handleOtaMqttMessage(const char* topic, const byte* payload, unsigned int length);
+
+// True while an update is being received.
+bool otaInProgress();
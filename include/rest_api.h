@@ -10,6 +10,9 @@ struct DeviceConfig {
     bool publishHumidity;       // Whether to publish humidity readings
     String tempSensorId;        // Sensor ID for temperature
     String humSensorId;         // Sensor ID for humidity
+    bool lowPower;              // Duty-cycled battery mode: sleep between samples, upload in batches
+    uint32_t flushIntervalMs;   // Low-power mode: interval between Wi-Fi wake-ups to upload the batch
+    bool deepSleep;             // Low-power mode: deep sleep (true) or light sleep (false) between samples
 
     // Internal flag to signal that status has changed and should be re-published
     bool statusDirty;
@@ -22,5 +25,9 @@ void initRestApi();
 // Call regularly from loop() to handle HTTP requests.
 void restApiLoop();
 
+// Apply a JSON object with any subset of the config fields (same format as
+// POST /config), e.g. received on MQTT_TOPIC_CONFIG. Returns false on bad JSON.
+bool applyDeviceConfigJson(const char* json, size_t length);
+
 // Access the mutable device configuration.
 DeviceConfig& getDeviceConfig();
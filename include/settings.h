@@ -40,6 +40,13 @@
 // Common derived topics for quick testing
 #define MQTT_TOPIC_STATUS   MQTT_BASE_TOPIC "/status"   // publishes device status/heartbeat
 #define MQTT_TOPIC_COMMAND  MQTT_BASE_TOPIC "/cmd"      // subscribe here to receive commands
+#define MQTT_TOPIC_CONFIG   MQTT_BASE_TOPIC "/config"   // subscribe here for config changes (retained JSON, same fields as REST)
+#define MQTT_TOPIC_OTA      MQTT_BASE_TOPIC "/ota"      // subscribe here to receive OTA patch chunks
+#define MQTT_TOPIC_OTA_STATUS MQTT_BASE_TOPIC "/ota/status" // publishes OTA progress ("next <offset>", "done", "error <reason>")
+
+// PubSubClient packet buffer. Must hold one OTA chunk plus topic and header
+// (the library default of 256 bytes is too small for firmware transfers).
+#define MQTT_BUFFER_SIZE 1280
 
 // =====================
 // AsyncAPI-compatible channels for sensor state
@@ -74,6 +81,9 @@
 // Endpoint path used for getting/setting runtime configuration
 #define REST_API_CONFIG_PATH "/config"
 
+// Endpoint path used to trigger an HTTP OTA update: POST {"url":"http://host/fw.iotp"}
+#define REST_API_OTA_PATH "/ota"
+
 // Default device status string exposed via REST and also published to MQTT
 #define REST_DEFAULT_STATUS "online"
 
@@ -84,6 +94,38 @@
 #define REST_DEFAULT_PUBLISH_TEMPERATURE 1
 #define REST_DEFAULT_PUBLISH_HUMIDITY 1
 
+// =====================
+// OTA update configuration
+// =====================
+
+// Abort an HTTP download if no data arrives for this long (milliseconds)
+#define OTA_HTTP_TIMEOUT_MS 15000
+
+// =====================
+// Low-power (battery) mode
+// =====================
+// When enabled, the device sleeps between samples (sendIntervalMs), keeps
+// readings compressed in RTC memory and only turns on Wi-Fi every
+// flushIntervalMs to upload the batch and fetch config from MQTT_TOPIC_CONFIG.
+// All three defaults can be changed at runtime via REST or MQTT config.
+
+// Start in low-power mode after power-on (1 = true, 0 = false)
+#define LOW_POWER_DEFAULT_ENABLED 0
+
+// Default interval between batch uploads (milliseconds) and the enforced minimum
+#define LOW_POWER_DEFAULT_FLUSH_INTERVAL_MS 600000
+#define LOW_POWER_MIN_FLUSH_INTERVAL_MS 10000
+
+// Sleep between samples: 1 = deep sleep (lowest current, wake is a reboot), 0 = light sleep
+#define LOW_POWER_DEFAULT_DEEP_SLEEP 1
+
+// RTC memory reserved for each buffered series (temperature, humidity). The
+// ESP32 has 8 KB of RTC slow memory; 1 KB holds several hundred samples.
+#define LOW_POWER_BUFFER_BYTES 1024
+
+// How long to stay connected after a flush to receive retained config (milliseconds)
+#define LOW_POWER_CONFIG_WAIT_MS 1000
+
 // =====================
 // Sensor configuration
 // =====================
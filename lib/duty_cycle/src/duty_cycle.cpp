@@ -0,0 +1,121 @@
+#include "duty_cycle.h"
+
+// Wrap-safe "a is at or after b" for a free-running 32-bit millisecond clock
+static bool reached(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) >= 0;
+}
+
+void dutyCycleReset(DutyCycleState& state, const DutyCycleConfig& cfg, uint32_t nowMs) {
+    state.nextSampleMs = nowMs;
+    state.nextFlushMs = nowMs + cfg.flushIntervalMs;
+    state.buffered = 0;
+    state.lastFlushFailed = false;
+}
+
+bool dutyCycleSampleDue(const DutyCycleState& state, uint32_t nowMs) {
+    return reached(nowMs, state.nextSampleMs);
+}
+
+void dutyCycleOnSample(DutyCycleState& state, const DutyCycleConfig& cfg, uint32_t nowMs) {
+    uint32_t interval = cfg.sampleIntervalMs > 0 ? cfg.sampleIntervalMs : 1;
+    state.nextSampleMs += interval;
+    if (reached(nowMs, state.nextSampleMs)) {
+        state.nextSampleMs = nowMs + interval;
+    }
+    if (state.buffered < 0xFFFF) state.buffered++;
+}
+
+bool dutyCycleFlushDue(const DutyCycleState& state, uint32_t nowMs, bool bufferFull) {
+    if (reached(nowMs, state.nextFlushMs)) return true;
+    return bufferFull && state.buffered > 0 && !state.lastFlushFailed;
+}
+
+void dutyCycleOnFlush(DutyCycleState& state, const DutyCycleConfig& cfg, uint32_t nowMs, bool success) {
+    uint32_t interval = cfg.flushIntervalMs > 0 ? cfg.flushIntervalMs : 1;
+    state.nextFlushMs += interval;
+    if (reached(nowMs, state.nextFlushMs)) {
+        state.nextFlushMs = nowMs + interval;
+    }
+    state.lastFlushFailed = !success;
+    if (success) state.buffered = 0;
+}
+
+void dutyCycleClampToClock(DutyCycleState& state, const DutyCycleConfig& cfg, uint32_t nowMs) {
+    if (!reached(nowMs, state.nextSampleMs) && state.nextSampleMs - nowMs > cfg.sampleIntervalMs) {
+        state.nextSampleMs = nowMs + cfg.sampleIntervalMs;
+    }
+    if (!reached(nowMs, state.nextFlushMs) && state.nextFlushMs - nowMs > cfg.flushIntervalMs) {
+        state.nextFlushMs = nowMs + cfg.flushIntervalMs;
+    }
+}
+
+uint32_t dutyCycleSleepMs(const DutyCycleState& state, uint32_t nowMs) {
+    return reached(nowMs, state.nextSampleMs) ? 0 : state.nextSampleMs - nowMs;
+}
+
+EnergyProfile defaultEsp32EnergyProfile() {
+    EnergyProfile p;
+    p.activeMa = 40.0f;       // 80-160 MHz, radio off
+    p.radioMa = 120.0f;       // Wi-Fi TX/RX bursts during association and publish
+    p.lightSleepMa = 0.8f;
+    p.deepSleepMa = 0.01f;    // RTC timer + RTC slow memory retained
+    p.quiescentMa = 0.15f;    // DHT11 standby
+    p.alwaysOnMa = 100.0f;    // connected STA with 10 ms polling loop
+    p.sampleAwakeMs = 30;
+    p.deepWakeBootMs = 250;
+    p.flushAwakeMs = 3000;
+    p.flushPerSampleMs = 2;
+    return p;
+}
+
+DutyCycleSimResult simulateDutyCycle(const DutyCycleConfig& cfg, const EnergyProfile& profile,
+                                     uint32_t durationMs, uint16_t bufferCapacity,
+                                     uint32_t flushFailEvery) {
+    DutyCycleSimResult res = {0, 0, 0, 0, 0, 0};
+    DutyCycleState state;
+    bool deep = cfg.sleepMode == SLEEP_DEEP;
+    double sleepMa = deep ? profile.deepSleepMa : profile.lightSleepMa;
+    double mAms = 0; // milliamp-milliseconds
+    uint32_t now = 0;
+
+    dutyCycleReset(state, cfg, now);
+    while (now < durationMs) {
+        uint32_t activeMs = 0;
+        uint32_t radioMs = 0;
+
+        // Deep sleep wakes through a full boot; the first iteration is the cold boot itself
+        if (deep && res.wakeups > 0) activeMs += profile.deepWakeBootMs;
+        res.wakeups++;
+
+        if (dutyCycleSampleDue(state, now + activeMs)) {
+            activeMs += profile.sampleAwakeMs;
+            dutyCycleOnSample(state, cfg, now + activeMs);
+            res.samples++;
+        }
+
+        bool full = state.buffered >= bufferCapacity;
+        if (dutyCycleFlushDue(state, now + activeMs, full)) {
+            radioMs = profile.flushAwakeMs + profile.flushPerSampleMs * state.buffered;
+            res.flushes++;
+            bool ok = flushFailEvery == 0 || res.flushes % flushFailEvery != 0;
+            dutyCycleOnFlush(state, cfg, now + activeMs + radioMs, ok);
+        }
+
+        mAms += profile.activeMa * (double)activeMs + profile.radioMa * (double)radioMs;
+        res.radioOnMs += radioMs;
+        now += activeMs + radioMs;
+
+        uint32_t sleepMs = dutyCycleSleepMs(state, now);
+        mAms += sleepMa * (double)sleepMs;
+        now += sleepMs;
+    }
+
+    mAms += profile.quiescentMa * (double)now;
+    res.averageMa = mAms / (double)now;
+    res.mahPerDay = res.averageMa * 24.0;
+    return res;
+}
+
+double alwaysOnMahPerDay(const EnergyProfile& profile) {
+    return (profile.alwaysOnMa + profile.quiescentMa) * 24.0;
+}
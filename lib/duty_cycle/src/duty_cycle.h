@@ -0,0 +1,96 @@
+#pragma once
+
+#include <stdint.h>
+
+// =====================
+// Duty-cycle scheduler for the low-power mode
+// =====================
+// Decides, on every wake-up, whether a sample is due, whether the buffered
+// batch should be flushed over Wi-Fi, and how long to sleep afterwards. All
+// times are milliseconds on a monotonic clock supplied by the caller (wrap-
+// safe). The state is plain data so it can be kept in RTC memory across
+// deep sleep. No Arduino dependency; the same code runs in host simulations.
+
+enum SleepMode : uint8_t {
+    SLEEP_LIGHT = 0, // CPU paused, RAM kept, fast wake
+    SLEEP_DEEP = 1,  // only RTC domain powered, wake is a reboot
+};
+
+struct DutyCycleConfig {
+    uint32_t sampleIntervalMs; // time between sensor readings
+    uint32_t flushIntervalMs;  // time between radio wake-ups to upload the batch
+    uint8_t sleepMode;         // SleepMode
+};
+
+struct DutyCycleState {
+    uint32_t nextSampleMs;     // clock value at which the next sample is due
+    uint32_t nextFlushMs;      // clock value at which the next flush is due
+    uint16_t buffered;         // samples taken since the last successful flush
+    bool lastFlushFailed;      // suppresses buffer-full retries until the next flush slot
+};
+
+// Start a new schedule: first sample immediately, first flush one flush interval from now.
+void dutyCycleReset(DutyCycleState& state, const DutyCycleConfig& cfg, uint32_t nowMs);
+
+bool dutyCycleSampleDue(const DutyCycleState& state, uint32_t nowMs);
+
+// Record that a sample was taken (or attempted) and schedule the next one.
+// Keeps a fixed cadence; if the device fell behind by more than one interval
+// it resynchronizes instead of sampling in a burst.
+void dutyCycleOnSample(DutyCycleState& state, const DutyCycleConfig& cfg, uint32_t nowMs);
+
+// True if the batch should be uploaded now: the flush slot was reached, or
+// the buffer is full (unless the previous attempt already failed).
+bool dutyCycleFlushDue(const DutyCycleState& state, uint32_t nowMs, bool bufferFull);
+
+// Record a flush attempt and schedule the next one on the same fixed cadence.
+// A failed attempt keeps the buffered samples for the next slot.
+void dutyCycleOnFlush(DutyCycleState& state, const DutyCycleConfig& cfg, uint32_t nowMs, bool success);
+
+// Pull the schedule back in range after the clock was stepped (e.g. an NTP
+// correction of the wall clock the firmware schedules on): a slot further
+// away than one interval is moved to one interval from now.
+void dutyCycleClampToClock(DutyCycleState& state, const DutyCycleConfig& cfg, uint32_t nowMs);
+
+// Milliseconds to sleep until the next sample is due (0 if already due).
+uint32_t dutyCycleSleepMs(const DutyCycleState& state, uint32_t nowMs);
+
+// =====================
+// Energy model
+// =====================
+// Average currents per phase and phase durations. Defaults are typical ESP32
+// module figures (datasheet/measured values); dev boards with USB-UART and
+// LDO add several mA of quiescent current, so adjust quiescentMa for those.
+struct EnergyProfile {
+    float activeMa;          // CPU running, radio off (boot, sensor read)
+    float radioMa;           // Wi-Fi association, MQTT connect and publish
+    float lightSleepMa;
+    float deepSleepMa;
+    float quiescentMa;       // always drawn: sensor standby, regulator
+    float alwaysOnMa;        // average of the always-on firmware (radio connected)
+    uint32_t sampleAwakeMs;  // awake time to read the DHT11
+    uint32_t deepWakeBootMs; // extra boot time after each deep-sleep wake-up
+    uint32_t flushAwakeMs;   // Wi-Fi + MQTT connect, config fetch
+    uint32_t flushPerSampleMs; // publish cost per buffered sample
+};
+
+EnergyProfile defaultEsp32EnergyProfile();
+
+struct DutyCycleSimResult {
+    double mahPerDay;
+    double averageMa;
+    uint32_t wakeups;
+    uint32_t samples;
+    uint32_t flushes;
+    uint32_t radioOnMs;      // total radio-on time over the simulated period
+};
+
+// Run the scheduler against a simulated clock for durationMs and integrate
+// the energy model. bufferCapacity is the number of samples the RTC buffer
+// holds; flushFailEvery > 0 makes every n-th flush attempt fail (0 = never).
+DutyCycleSimResult simulateDutyCycle(const DutyCycleConfig& cfg, const EnergyProfile& profile,
+                                     uint32_t durationMs, uint16_t bufferCapacity,
+                                     uint32_t flushFailEvery = 0);
+
+// mAh/day of the always-on firmware for comparison.
+double alwaysOnMahPerDay(const EnergyProfile& profile);
@@ -0,0 +1,229 @@
+#include <string.h>
+
+#include "ota_patch.h"
+
+static uint32_t readLe32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+const char* otaPatchStatusName(OtaPatchStatus status) {
+    switch (status) {
+        case OtaPatchStatus::Ok: return "ok";
+        case OtaPatchStatus::Done: return "done";
+        case OtaPatchStatus::BadHeader: return "bad-header";
+        case OtaPatchStatus::BaseMismatch: return "base-mismatch";
+        case OtaPatchStatus::BaseReadError: return "base-read-error";
+        case OtaPatchStatus::WriteError: return "write-error";
+        case OtaPatchStatus::Corrupt: return "corrupt";
+        case OtaPatchStatus::SizeMismatch: return "size-mismatch";
+        case OtaPatchStatus::HashMismatch: return "hash-mismatch";
+    }
+    return "unknown";
+}
+
+OtaPatchApplier::OtaPatchApplier(OtaPatchSink& sink, OtaPatchBase* base)
+    : sink_(sink), base_(base) {
+    reset();
+}
+
+void OtaPatchApplier::reset() {
+    sha_.reset();
+    state_ = State::Header;
+    status_ = OtaPatchStatus::Ok;
+    headerLen_ = 0;
+    flags_ = 0;
+    targetSize_ = 0;
+    baseSize_ = 0;
+    op_ = OTA_OP_END;
+    arg1_ = 0;
+    arg2_ = 0;
+    varintShift_ = 0;
+    literalLeft_ = 0;
+    baseCursor_ = 0;
+    written_ = 0;
+    windowPos_ = 0;
+    outLen_ = 0;
+}
+
+OtaPatchStatus OtaPatchApplier::feed(const uint8_t* data, size_t len) {
+    size_t i = 0;
+    while (status_ == OtaPatchStatus::Ok && i < len) {
+        switch (state_) {
+            case State::Header: {
+                size_t take = OTA_PATCH_HEADER_SIZE - headerLen_;
+                if (take > len - i) take = len - i;
+                memcpy(header_ + headerLen_, data + i, take);
+                headerLen_ += take;
+                i += take;
+                if (headerLen_ == OTA_PATCH_HEADER_SIZE) {
+                    status_ = parseHeader();
+                }
+                break;
+            }
+
+            case State::Opcode:
+                op_ = data[i++];
+                arg1_ = 0;
+                arg2_ = 0;
+                varintShift_ = 0;
+                if (op_ == OTA_OP_END) {
+                    status_ = finish();
+                } else if (op_ == OTA_OP_LITERAL || op_ == OTA_OP_MATCH || op_ == OTA_OP_BASE) {
+                    state_ = State::Arg1;
+                } else {
+                    status_ = OtaPatchStatus::Corrupt;
+                }
+                break;
+
+            case State::Arg1:
+            case State::Arg2: {
+                uint8_t b = data[i++];
+                if (varintShift_ > 28) {
+                    status_ = OtaPatchStatus::Corrupt;
+                    break;
+                }
+                uint32_t& arg = (state_ == State::Arg1) ? arg1_ : arg2_;
+                arg |= (uint32_t)(b & 0x7F) << varintShift_;
+                varintShift_ += 7;
+                if (b & 0x80) break;
+
+                varintShift_ = 0;
+                if (op_ == OTA_OP_LITERAL) {
+                    literalLeft_ = arg1_;
+                    state_ = literalLeft_ > 0 ? State::Literal : State::Opcode;
+                } else if (state_ == State::Arg1) {
+                    state_ = State::Arg2;
+                } else {
+                    status_ = execute();
+                    state_ = State::Opcode;
+                }
+                break;
+            }
+
+            case State::Literal: {
+                size_t take = literalLeft_;
+                if (take > len - i) take = len - i;
+                status_ = emit(data + i, take);
+                i += take;
+                literalLeft_ -= (uint32_t)take;
+                if (literalLeft_ == 0) state_ = State::Opcode;
+                break;
+            }
+
+            case State::Finished:
+                return status_;
+        }
+    }
+    return status_;
+}
+
+OtaPatchStatus OtaPatchApplier::parseHeader() {
+    if (memcmp(header_, OTA_PATCH_MAGIC, 4) != 0 || header_[4] != OTA_PATCH_VERSION) {
+        return OtaPatchStatus::BadHeader;
+    }
+    flags_ = header_[5];
+    targetSize_ = readLe32(header_ + 8);
+    baseSize_ = readLe32(header_ + 12);
+    memcpy(targetSha_, header_ + 48, sizeof(targetSha_));
+
+    if (isDelta()) {
+        // Refuse to patch anything but the exact image the delta was made from
+        if (!base_) return OtaPatchStatus::BaseReadError;
+        Sha256 baseSha;
+        for (uint32_t off = 0; off < baseSize_;) {
+            uint32_t take = baseSize_ - off;
+            if (take > sizeof(out_)) take = sizeof(out_);
+            if (!base_->read(off, out_, take)) return OtaPatchStatus::BaseReadError;
+            baseSha.update(out_, take);
+            off += take;
+        }
+        uint8_t digest[Sha256::DIGEST_SIZE];
+        baseSha.finish(digest);
+        if (memcmp(digest, header_ + 16, sizeof(digest)) != 0) {
+            return OtaPatchStatus::BaseMismatch;
+        }
+    } else if (baseSize_ != 0) {
+        return OtaPatchStatus::BadHeader;
+    }
+
+    if (!sink_.begin(targetSize_)) return OtaPatchStatus::WriteError;
+    state_ = State::Opcode;
+    return OtaPatchStatus::Ok;
+}
+
+OtaPatchStatus OtaPatchApplier::execute() {
+    uint8_t chunk[64];
+    uint32_t len = arg2_;
+
+    if (op_ == OTA_OP_MATCH) {
+        uint32_t dist = arg1_;
+        uint32_t available = written_ < OTA_PATCH_WINDOW_SIZE ? written_ : OTA_PATCH_WINDOW_SIZE;
+        if (dist == 0 || dist > available) return OtaPatchStatus::Corrupt;
+        // Copy in small pieces; emit() advances the window, which makes
+        // overlapping matches (dist < len) repeat correctly.
+        while (len > 0) {
+            uint32_t take = len < dist ? len : dist;
+            if (take > sizeof(chunk)) take = sizeof(chunk);
+            uint32_t src = (windowPos_ + OTA_PATCH_WINDOW_SIZE - dist) % OTA_PATCH_WINDOW_SIZE;
+            for (uint32_t k = 0; k < take; ++k) {
+                chunk[k] = window_[(src + k) % OTA_PATCH_WINDOW_SIZE];
+            }
+            OtaPatchStatus st = emit(chunk, take);
+            if (st != OtaPatchStatus::Ok) return st;
+            len -= take;
+        }
+        return OtaPatchStatus::Ok;
+    }
+
+    // OTA_OP_BASE: zigzag-decoded offset relative to the end of the previous base copy
+    if (!isDelta()) return OtaPatchStatus::Corrupt;
+    int32_t delta = (int32_t)(arg1_ >> 1) ^ -(int32_t)(arg1_ & 1);
+    int64_t offset = (int64_t)baseCursor_ + delta;
+    if (offset < 0 || offset + len > baseSize_) return OtaPatchStatus::Corrupt;
+    uint32_t pos = (uint32_t)offset;
+    while (len > 0) {
+        uint32_t take = len < sizeof(chunk) ? len : (uint32_t)sizeof(chunk);
+        if (!base_->read(pos, chunk, take)) return OtaPatchStatus::BaseReadError;
+        OtaPatchStatus st = emit(chunk, take);
+        if (st != OtaPatchStatus::Ok) return st;
+        pos += take;
+        len -= take;
+    }
+    baseCursor_ = pos;
+    return OtaPatchStatus::Ok;
+}
+
+OtaPatchStatus OtaPatchApplier::emit(const uint8_t* data, size_t len) {
+    if ((uint64_t)written_ + len > targetSize_) return OtaPatchStatus::SizeMismatch;
+    for (size_t k = 0; k < len; ++k) {
+        window_[windowPos_] = data[k];
+        windowPos_ = (windowPos_ + 1) % OTA_PATCH_WINDOW_SIZE;
+        out_[outLen_++] = data[k];
+        if (outLen_ == sizeof(out_)) {
+            OtaPatchStatus st = flushOut();
+            if (st != OtaPatchStatus::Ok) return st;
+        }
+    }
+    written_ += (uint32_t)len;
+    return OtaPatchStatus::Ok;
+}
+
+OtaPatchStatus OtaPatchApplier::flushOut() {
+    if (outLen_ == 0) return OtaPatchStatus::Ok;
+    sha_.update(out_, outLen_);
+    if (!sink_.write(out_, outLen_)) return OtaPatchStatus::WriteError;
+    outLen_ = 0;
+    return OtaPatchStatus::Ok;
+}
+
+OtaPatchStatus OtaPatchApplier::finish() {
+    state_ = State::Finished;
+    OtaPatchStatus st = flushOut();
+    if (st != OtaPatchStatus::Ok) return st;
+    if (written_ != targetSize_) return OtaPatchStatus::SizeMismatch;
+
+    uint8_t digest[Sha256::DIGEST_SIZE];
+    sha_.finish(digest);
+    if (memcmp(digest, targetSha_, sizeof(digest)) != 0) return OtaPatchStatus::HashMismatch;
+    return OtaPatchStatus::Done;
+}
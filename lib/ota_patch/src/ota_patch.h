@@ -0,0 +1,136 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sha256.h"
+
+// =====================
+// OTA patch stream format ("IOTP")
+// =====================
+// A patch is a fixed header followed by a stream of opcodes. It either
+// describes a full image (LZ-compressed against its own recent output) or a
+// delta against the firmware that is currently running. Both kinds are
+// applied by the same streaming applier with constant RAM.
+//
+// Header (little-endian, OTA_PATCH_HEADER_SIZE bytes):
+//   magic "IOTP" | version u8 | flags u8 | reserved u16
+//   targetSize u32 | baseSize u32 | baseSha256[32] | targetSha256[32]
+//
+// Opcodes (all lengths/offsets are LEB128 varints):
+//   END                         end of stream
+//   LITERAL len, bytes[len]     copy bytes from the patch
+//   MATCH   dist, len           copy from the last OTA_PATCH_WINDOW_SIZE output bytes
+//   BASE    zigzag(delta), len  copy from the base image at (baseCursor + delta);
+//                               baseCursor then advances to the end of the copy
+
+#define OTA_PATCH_MAGIC "IOTP"
+#define OTA_PATCH_VERSION 1
+#define OTA_PATCH_HEADER_SIZE 80
+
+// History kept for MATCH back-references. Generator and applier must agree.
+#define OTA_PATCH_WINDOW_SIZE 2048
+
+// Header flag: the patch copies from a base image (delta update)
+#define OTA_PATCH_FLAG_DELTA 0x01
+
+enum OtaPatchOp : uint8_t {
+    OTA_OP_END = 0,
+    OTA_OP_LITERAL = 1,
+    OTA_OP_MATCH = 2,
+    OTA_OP_BASE = 3,
+};
+
+enum class OtaPatchStatus : uint8_t {
+    Ok,            // bytes accepted, more input expected
+    Done,          // END reached and target hash verified
+    BadHeader,     // wrong magic/version or inconsistent sizes
+    BaseMismatch,  // base image hash differs from the one the patch was made for
+    BaseReadError, // base reader failed
+    WriteError,    // sink rejected a write
+    Corrupt,       // malformed opcode stream
+    SizeMismatch,  // output length differs from targetSize
+    HashMismatch,  // output hash differs from targetSha256
+};
+
+// Human-readable name for logs and MQTT status messages.
+const char* otaPatchStatusName(OtaPatchStatus status);
+
+// Destination of the reconstructed image (e.g. the inactive OTA partition).
+// Bytes are delivered strictly sequentially.
+class OtaPatchSink {
+public:
+    virtual ~OtaPatchSink() {}
+
+    // Called once the header is parsed, before the first write().
+    virtual bool begin(uint32_t targetSize) { (void)targetSize; return true; }
+
+    virtual bool write(const uint8_t* data, size_t len) = 0;
+};
+
+// Random-access reader for the base image of a delta patch (e.g. the running partition).
+class OtaPatchBase {
+public:
+    virtual ~OtaPatchBase() {}
+
+    virtual bool read(uint32_t offset, uint8_t* out, size_t len) = 0;
+};
+
+// Streaming patch applier. Feed the patch in chunks of any size; output is
+// written to the sink as it is produced. RAM use is fixed by the window and
+// output buffer regardless of image size.
+class OtaPatchApplier {
+public:
+    // base may be nullptr if only full (non-delta) patches are expected.
+    OtaPatchApplier(OtaPatchSink& sink, OtaPatchBase* base);
+
+    // Forget any partially applied patch and wait for a new header.
+    void reset();
+
+    // Consume the next part of the patch. Returns Ok while more input is
+    // expected, Done after the target hash was verified, or an error. Once
+    // an error or Done is returned the applier ignores input until reset().
+    OtaPatchStatus feed(const uint8_t* data, size_t len);
+
+    OtaPatchStatus status() const { return status_; }
+    bool headerParsed() const { return state_ != State::Header; }
+    bool isDelta() const { return (flags_ & OTA_PATCH_FLAG_DELTA) != 0; }
+    uint32_t targetSize() const { return targetSize_; }
+    uint32_t bytesWritten() const { return written_; }
+
+private:
+    enum class State : uint8_t { Header, Opcode, Arg1, Arg2, Literal, Finished };
+
+    OtaPatchStatus parseHeader();
+    OtaPatchStatus execute();
+    OtaPatchStatus finish();
+    OtaPatchStatus emit(const uint8_t* data, size_t len);
+    OtaPatchStatus flushOut();
+
+    OtaPatchSink& sink_;
+    OtaPatchBase* base_;
+    Sha256 sha_;
+
+    State state_;
+    OtaPatchStatus status_;
+
+    uint8_t header_[OTA_PATCH_HEADER_SIZE];
+    size_t headerLen_;
+    uint8_t flags_;
+    uint32_t targetSize_;
+    uint32_t baseSize_;
+    uint8_t targetSha_[Sha256::DIGEST_SIZE];
+
+    uint8_t op_;
+    uint32_t arg1_;
+    uint32_t arg2_;
+    uint8_t varintShift_;
+    uint32_t literalLeft_;
+    uint32_t baseCursor_;
+
+    uint32_t written_;
+    uint8_t window_[OTA_PATCH_WINDOW_SIZE];
+    uint32_t windowPos_;
+    uint8_t out_[256];
+    size_t outLen_;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdio.h>
+
+#include "ota_patch.h"
+
+// File-backed stand-in for a flash partition, used by host tools and native
+// tests. Acts as the sink (inactive partition) and/or base (running
+// partition) of an OtaPatchApplier. capacity mimics the partition size.
+class OtaFilePartition : public OtaPatchSink, public OtaPatchBase {
+public:
+    OtaFilePartition(FILE* file, uint32_t capacity) : file_(file), capacity_(capacity) {}
+
+    bool begin(uint32_t targetSize) override {
+        writePos_ = 0;
+        return file_ && targetSize <= capacity_ && fseek(file_, 0, SEEK_SET) == 0;
+    }
+
+    bool write(const uint8_t* data, size_t len) override {
+        if (!file_ || writePos_ + len > capacity_) return false;
+        if (fseek(file_, (long)writePos_, SEEK_SET) != 0) return false;
+        if (fwrite(data, 1, len, file_) != len) return false;
+        writePos_ += (uint32_t)len;
+        writes_++;
+        return true;
+    }
+
+    bool read(uint32_t offset, uint8_t* out, size_t len) override {
+        if (!file_ || offset + len > capacity_) return false;
+        if (fseek(file_, (long)offset, SEEK_SET) != 0) return false;
+        return fread(out, 1, len, file_) == len;
+    }
+
+    uint32_t bytesWritten() const { return writePos_; }
+    uint32_t writeCount() const { return writes_; }
+
+private:
+    FILE* file_;
+    uint32_t capacity_;
+    uint32_t writePos_ = 0;
+    uint32_t writes_ = 0;
+};
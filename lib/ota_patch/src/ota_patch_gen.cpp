@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <string.h>
+
+#include "ota_patch_gen.h"
+
+// Shortest copies worth encoding; shorter runs stay literals
+static const size_t MIN_MATCH = 4;
+static const size_t MIN_BASE_MATCH = 8;
+
+// Bounded candidate search keeps generation fast on multi-megabyte images
+static const int MAX_CHAIN = 48;
+static const uint32_t BASE_HASH_BITS = 18;
+static const uint32_t WINDOW_HASH_BITS = 15;
+static const int32_t NO_POS = -1;
+
+static void putLe32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static void putVarint(std::vector<uint8_t>& out, uint32_t v) {
+    while (v >= 0x80) {
+        out.push_back((uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((uint8_t)v);
+}
+
+static size_t varintSize(uint32_t v) {
+    size_t n = 1;
+    while (v >= 0x80) { v >>= 7; ++n; }
+    return n;
+}
+
+static uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static uint32_t hashBytes(const uint8_t* p, size_t n, uint32_t bits) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; ++i) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h >> (32 - bits);
+}
+
+static size_t matchLength(const uint8_t* a, const uint8_t* b, size_t maxLen) {
+    size_t n = 0;
+    while (n < maxLen && a[n] == b[n]) ++n;
+    return n;
+}
+
+// Simple head/prev hash chain over positions of one buffer
+struct HashChain {
+    HashChain(uint32_t bits, size_t positions, size_t keyLen)
+        : bits(bits), keyLen(keyLen), head((size_t)1 << bits, NO_POS), prev(positions, NO_POS) {}
+
+    void insert(const uint8_t* data, size_t len, size_t pos) {
+        if (pos + keyLen > len) return;
+        uint32_t h = hashBytes(data + pos, keyLen, bits);
+        prev[pos] = head[h];
+        head[h] = (int32_t)pos;
+    }
+
+    uint32_t bits;
+    size_t keyLen;
+    std::vector<int32_t> head;
+    std::vector<int32_t> prev;
+};
+
+namespace {
+
+struct Candidate {
+    uint8_t op = OTA_OP_END;
+    uint32_t arg = 0;     // distance (MATCH) or zigzag delta (BASE)
+    size_t len = 0;
+    long score = 0;       // bytes saved compared to emitting literals
+};
+
+void consider(Candidate& best, uint8_t op, uint32_t arg, size_t len) {
+    long cost = 1 + (long)varintSize(arg) + (long)varintSize((uint32_t)len);
+    long score = (long)len - cost;
+    if (score > best.score) {
+        best.op = op;
+        best.arg = arg;
+        best.len = len;
+        best.score = score;
+    }
+}
+
+void flushLiterals(std::vector<uint8_t>& out, const uint8_t* target, size_t start, size_t end) {
+    if (end <= start) return;
+    out.push_back(OTA_OP_LITERAL);
+    putVarint(out, (uint32_t)(end - start));
+    out.insert(out.end(), target + start, target + end);
+}
+
+}  // namespace
+
+std::vector<uint8_t> otaPatchCreate(const uint8_t* target, size_t targetLen,
+                                    const uint8_t* base, size_t baseLen) {
+    std::vector<uint8_t> out;
+    bool delta = base != nullptr;
+
+    // Header
+    uint8_t digest[Sha256::DIGEST_SIZE];
+    Sha256 sha;
+    out.insert(out.end(), OTA_PATCH_MAGIC, OTA_PATCH_MAGIC + 4);
+    out.push_back(OTA_PATCH_VERSION);
+    out.push_back(delta ? OTA_PATCH_FLAG_DELTA : 0);
+    out.push_back(0);
+    out.push_back(0);
+    putLe32(out, (uint32_t)targetLen);
+    putLe32(out, delta ? (uint32_t)baseLen : 0);
+    if (delta) {
+        sha.update(base, baseLen);
+        sha.finish(digest);
+    } else {
+        memset(digest, 0, sizeof(digest));
+    }
+    out.insert(out.end(), digest, digest + sizeof(digest));
+    sha.reset();
+    sha.update(target, targetLen);
+    sha.finish(digest);
+    out.insert(out.end(), digest, digest + sizeof(digest));
+
+    HashChain baseChain(BASE_HASH_BITS, delta ? baseLen : 0, MIN_BASE_MATCH);
+    if (delta) {
+        for (size_t p = 0; p < baseLen; ++p) baseChain.insert(base, baseLen, p);
+    }
+    HashChain window(WINDOW_HASH_BITS, targetLen, MIN_MATCH);
+
+    size_t pos = 0;
+    size_t literalStart = 0;
+    uint32_t baseCursor = 0;      // applier's base cursor after the last BASE op
+    size_t targetAtCursor = 0;    // target position that followed the last BASE op
+
+    while (pos < targetLen) {
+        Candidate best;
+        size_t remaining = targetLen - pos;
+
+        if (delta) {
+            // Most firmware edits keep the following code in place (or shifted
+            // by a constant), so first try continuing from where the last copy ended.
+            size_t expected = baseCursor + (pos - targetAtCursor);
+            if (expected < baseLen) {
+                size_t n = matchLength(target + pos, base + expected, std::min(remaining, baseLen - expected));
+                if (n >= MIN_BASE_MATCH) {
+                    consider(best, OTA_OP_BASE, zigzag((int32_t)((int64_t)expected - baseCursor)), n);
+                }
+            }
+            if (remaining >= MIN_BASE_MATCH) {
+                int32_t cand = baseChain.head[hashBytes(target + pos, MIN_BASE_MATCH, BASE_HASH_BITS)];
+                for (int depth = 0; cand != NO_POS && depth < MAX_CHAIN; ++depth) {
+                    size_t n = matchLength(target + pos, base + cand, std::min(remaining, baseLen - (size_t)cand));
+                    if (n >= MIN_BASE_MATCH) {
+                        consider(best, OTA_OP_BASE, zigzag((int32_t)((int64_t)cand - baseCursor)), n);
+                    }
+                    cand = baseChain.prev[cand];
+                }
+            }
+        }
+
+        if (remaining >= MIN_MATCH) {
+            int32_t cand = window.head[hashBytes(target + pos, MIN_MATCH, WINDOW_HASH_BITS)];
+            for (int depth = 0; cand != NO_POS && depth < MAX_CHAIN; ++depth) {
+                size_t dist = pos - (size_t)cand;
+                if (dist > OTA_PATCH_WINDOW_SIZE) break;
+                size_t n = matchLength(target + pos, target + cand, remaining);
+                if (n >= MIN_MATCH) consider(best, OTA_OP_MATCH, (uint32_t)dist, n);
+                cand = window.prev[cand];
+            }
+        }
+
+        if (best.score <= 0) {
+            window.insert(target, targetLen, pos);
+            ++pos;
+            continue;
+        }
+
+        flushLiterals(out, target, literalStart, pos);
+        out.push_back(best.op);
+        putVarint(out, best.arg);
+        putVarint(out, (uint32_t)best.len);
+        if (best.op == OTA_OP_BASE) {
+            int32_t d = (int32_t)(best.arg >> 1) ^ -(int32_t)(best.arg & 1);
+            baseCursor = (uint32_t)((int64_t)baseCursor + d + (int64_t)best.len);
+            targetAtCursor = pos + best.len;
+        }
+        for (size_t k = 0; k < best.len; ++k) window.insert(target, targetLen, pos + k);
+        pos += best.len;
+        literalStart = pos;
+    }
+
+    flushLiterals(out, target, literalStart, pos);
+    out.push_back(OTA_OP_END);
+    return out;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "ota_patch.h"
+
+// Host-side patch generator (uses heap memory proportional to the images;
+// not intended to run on the device).
+//
+// Builds an "IOTP" patch that reconstructs target. If base is non-null the
+// patch is a delta against base (copies are taken from base where possible,
+// falling back to LZ matches and literals); otherwise it is a full image
+// compressed against its own history.
+std::vector<uint8_t> otaPatchCreate(const uint8_t* target, size_t targetLen,
+                                    const uint8_t* base = nullptr, size_t baseLen = 0);
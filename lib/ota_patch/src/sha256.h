@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Minimal streaming SHA-256 (FIPS 180-4). Portable so the same code verifies
+// OTA images on the ESP32 and in host-side tools/tests.
+struct Sha256 {
+    static const size_t DIGEST_SIZE = 32;
+
+    Sha256() { reset(); }
+
+    // Start a fresh digest.
+    void reset();
+
+    // Feed more bytes; may be called any number of times.
+    void update(const uint8_t* data, size_t len);
+
+    // Finish and write DIGEST_SIZE bytes to out. Call reset() before reuse.
+    void finish(uint8_t out[DIGEST_SIZE]);
+
+private:
+    void compress(const uint8_t block[64]);
+
+    uint32_t state_[8];
+    uint64_t totalLen_;
+    uint8_t buffer_[64];
+    size_t bufferLen_;
+};
@@ -0,0 +1,282 @@
+#include <math.h>
+#include <string.h>
+
+#include "ts_codec.h"
+
+// Sentinel for "no XOR window yet"
+static const uint8_t NO_WINDOW = 0xFF;
+
+static const float POW10[] = {1.0f, 10.0f, 100.0f, 1000.0f, 10000.0f, 100000.0f, 1000000.0f};
+
+static uint32_t floatBits(float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+static float bitsFloat(uint32_t bits) {
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+static uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+// =====================
+// Encoder
+// =====================
+
+bool TsEncoder::begin(uint8_t* buf, size_t cap, TsValueMode mode, uint8_t decimals) {
+    if (!buf || cap < TS_CODEC_HEADER_SIZE || cap > 0x1FFFFFFF) return false;
+    if (mode == TS_VALUE_FIXED && decimals >= sizeof(POW10) / sizeof(POW10[0])) return false;
+
+    buf_ = buf;
+    cap_ = (uint32_t)cap;
+    count_ = 0;
+    mode_ = mode;
+    decimals_ = mode == TS_VALUE_FIXED ? decimals : 0;
+    prevTimestamp_ = 0;
+    prevDelta_ = 0;
+    prevValueBits_ = 0;
+    prevLeading_ = NO_WINDOW;
+    prevTrailing_ = 0;
+
+    buf_[0] = (uint8_t)((TS_CODEC_VERSION << 4) | (mode_ & 0x0F));
+    buf_[1] = decimals_;
+    buf_[2] = 0;
+    buf_[3] = 0;
+    bitPos_ = TS_CODEC_HEADER_SIZE * 8;
+    return true;
+}
+
+bool TsEncoder::writeBits(uint64_t value, uint8_t bits) {
+    if (bitPos_ + bits > cap_ * 8) return false;
+    while (bits > 0) {
+        uint32_t idx = bitPos_ >> 3;
+        uint8_t space = 8 - (bitPos_ & 7);
+        uint8_t take = bits < space ? bits : space;
+        uint8_t shift = space - take;
+        uint8_t mask = (uint8_t)(((1u << take) - 1) << shift);
+        uint8_t chunk = (uint8_t)((value >> (bits - take)) << shift) & mask;
+        // Overwrite rather than OR so bytes left over from a rolled-back append don't leak in
+        buf_[idx] = (uint8_t)((buf_[idx] & ~mask) | chunk);
+        bitPos_ += take;
+        bits -= take;
+    }
+    return true;
+}
+
+bool TsEncoder::writeTimestamp(uint32_t timestamp) {
+    int64_t delta = (int64_t)timestamp - (int64_t)prevTimestamp_;
+    int64_t dod = delta - prevDelta_;
+    bool ok;
+    if (dod == 0) {
+        ok = writeBits(0x0, 1);
+    } else if (dod >= -63 && dod <= 64) {
+        ok = writeBits(0x2, 2) && writeBits((uint64_t)(dod + 63), 7);
+    } else if (dod >= -255 && dod <= 256) {
+        ok = writeBits(0x6, 3) && writeBits((uint64_t)(dod + 255), 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+        ok = writeBits(0xE, 4) && writeBits((uint64_t)(dod + 2047), 12);
+    } else {
+        ok = writeBits(0xF, 4) && writeBits(zigzag(dod), 33);
+    }
+    prevDelta_ = delta;
+    prevTimestamp_ = timestamp;
+    return ok;
+}
+
+bool TsEncoder::writeXor(uint32_t bits) {
+    uint32_t x = bits ^ prevValueBits_;
+    prevValueBits_ = bits;
+    if (x == 0) {
+        return writeBits(0x0, 1);
+    }
+
+    uint8_t leading = (uint8_t)__builtin_clz(x);
+    uint8_t trailing = (uint8_t)__builtin_ctz(x);
+    if (prevLeading_ != NO_WINDOW && leading >= prevLeading_ && trailing >= prevTrailing_) {
+        // Meaningful bits fit in the previous window; skip re-sending its bounds
+        uint8_t len = 32 - prevLeading_ - prevTrailing_;
+        return writeBits(0x2, 2) && writeBits(x >> prevTrailing_, len);
+    }
+
+    uint8_t len = 32 - leading - trailing;
+    prevLeading_ = leading;
+    prevTrailing_ = trailing;
+    return writeBits(0x3, 2) && writeBits(leading, 5) && writeBits(len - 1, 5) &&
+           writeBits(x >> trailing, len);
+}
+
+bool TsEncoder::writeFixed(int32_t scaled) {
+    uint64_t z = zigzag((int64_t)scaled - (int64_t)(int32_t)prevValueBits_);
+    prevValueBits_ = (uint32_t)scaled;
+    if (z == 0) return writeBits(0x0, 1);
+    if (z < (1u << 4)) return writeBits(0x2, 2) && writeBits(z, 4);
+    if (z < (1u << 8)) return writeBits(0x6, 3) && writeBits(z, 8);
+    if (z < (1u << 16)) return writeBits(0xE, 4) && writeBits(z, 16);
+    return writeBits(0xF, 4) && writeBits(z, 33);
+}
+
+bool TsEncoder::append(uint32_t timestamp, float value) {
+    if (!buf_ || count_ >= TS_CODEC_MAX_SAMPLES) return false;
+    if (count_ > 0 && timestamp < prevTimestamp_) return false;
+
+    uint32_t valueBits;
+    if (mode_ == TS_VALUE_FIXED) {
+        float scaled = value * POW10[decimals_];
+        if (!(scaled > -2147483520.0f && scaled < 2147483520.0f)) return false; // also rejects NaN
+        valueBits = (uint32_t)(int32_t)lroundf(scaled);
+    } else {
+        valueBits = floatBits(value);
+    }
+
+    TsEncoder saved = *this;
+    bool ok;
+    if (count_ == 0) {
+        prevTimestamp_ = timestamp;
+        prevValueBits_ = valueBits;
+        ok = writeBits(timestamp, 32) && writeBits(valueBits, 32);
+    } else {
+        ok = writeTimestamp(timestamp) &&
+             (mode_ == TS_VALUE_FIXED ? writeFixed((int32_t)valueBits) : writeXor(valueBits));
+    }
+    if (!ok) {
+        *this = saved;
+        return false;
+    }
+
+    count_++;
+    buf_[2] = (uint8_t)count_;
+    buf_[3] = (uint8_t)(count_ >> 8);
+    return true;
+}
+
+// =====================
+// Decoder
+// =====================
+
+TsDecoder::TsDecoder(const uint8_t* buf, size_t len)
+    : buf_(buf), len_(len), bitPos_(TS_CODEC_HEADER_SIZE * 8), valid_(false), count_(0), index_(0),
+      mode_(0), decimals_(0), prevTimestamp_(0), prevDelta_(0), prevValueBits_(0),
+      prevLeading_(NO_WINDOW), prevTrailing_(0) {
+    if (!buf_ || len_ < TS_CODEC_HEADER_SIZE || (buf_[0] >> 4) != TS_CODEC_VERSION) return;
+    mode_ = buf_[0] & 0x0F;
+    decimals_ = buf_[1];
+    if (mode_ > TS_VALUE_FIXED || decimals_ >= sizeof(POW10) / sizeof(POW10[0])) return;
+    count_ = (uint16_t)(buf_[2] | (buf_[3] << 8));
+    valid_ = true;
+}
+
+bool TsDecoder::readBits(uint8_t bits, uint64_t& out) {
+    if (bitPos_ + bits > len_ * 8) return false;
+    out = 0;
+    while (bits > 0) {
+        size_t idx = bitPos_ >> 3;
+        uint8_t space = 8 - (bitPos_ & 7);
+        uint8_t take = bits < space ? bits : space;
+        uint8_t chunk = (uint8_t)(buf_[idx] >> (space - take)) & (uint8_t)((1u << take) - 1);
+        out = (out << take) | chunk;
+        bitPos_ += take;
+        bits -= take;
+    }
+    return true;
+}
+
+bool TsDecoder::readTimestamp(uint32_t& timestamp) {
+    // Bucket prefix: count leading 1 bits (at most 4)
+    uint64_t bit = 1;
+    uint8_t ones = 0;
+    while (ones < 4) {
+        if (!readBits(1, bit)) return false;
+        if (bit == 0) break;
+        ones++;
+    }
+
+    uint64_t raw = 0;
+    int64_t dod;
+    switch (ones) {
+        case 0: dod = 0; break;
+        case 1: if (!readBits(7, raw)) return false; dod = (int64_t)raw - 63; break;
+        case 2: if (!readBits(9, raw)) return false; dod = (int64_t)raw - 255; break;
+        case 3: if (!readBits(12, raw)) return false; dod = (int64_t)raw - 2047; break;
+        default: if (!readBits(33, raw)) return false; dod = unzigzag(raw); break;
+    }
+    prevDelta_ += dod;
+    timestamp = (uint32_t)((int64_t)prevTimestamp_ + prevDelta_);
+    prevTimestamp_ = timestamp;
+    return true;
+}
+
+bool TsDecoder::readXor(uint32_t& bits) {
+    uint64_t flag, raw;
+    if (!readBits(1, flag)) return false;
+    if (flag == 0) {
+        bits = prevValueBits_;
+        return true;
+    }
+    if (!readBits(1, flag)) return false;
+    if (flag == 1) {
+        uint64_t leading, lenMinusOne;
+        if (!readBits(5, leading) || !readBits(5, lenMinusOne)) return false;
+        if (leading + lenMinusOne + 1 > 32) return false;
+        prevLeading_ = (uint8_t)leading;
+        prevTrailing_ = (uint8_t)(32 - leading - lenMinusOne - 1);
+    } else if (prevLeading_ == NO_WINDOW) {
+        return false;
+    }
+    uint8_t len = 32 - prevLeading_ - prevTrailing_;
+    if (!readBits(len, raw)) return false;
+    prevValueBits_ ^= (uint32_t)(raw << prevTrailing_);
+    bits = prevValueBits_;
+    return true;
+}
+
+bool TsDecoder::readFixed(int32_t& scaled) {
+    static const uint8_t WIDTHS[] = {0, 4, 8, 16, 33};
+    uint64_t bit = 1;
+    uint8_t ones = 0;
+    while (ones < 4) {
+        if (!readBits(1, bit)) return false;
+        if (bit == 0) break;
+        ones++;
+    }
+    uint64_t z = 0;
+    if (ones > 0 && !readBits(WIDTHS[ones], z)) return false;
+    prevValueBits_ = (uint32_t)((int64_t)(int32_t)prevValueBits_ + unzigzag(z));
+    scaled = (int32_t)prevValueBits_;
+    return true;
+}
+
+bool TsDecoder::next(uint32_t& timestamp, float& value) {
+    if (!valid_ || index_ >= count_) return false;
+
+    uint32_t valueBits;
+    if (index_ == 0) {
+        uint64_t ts, v;
+        if (!readBits(32, ts) || !readBits(32, v)) return false;
+        prevTimestamp_ = (uint32_t)ts;
+        prevValueBits_ = (uint32_t)v;
+        timestamp = prevTimestamp_;
+        valueBits = prevValueBits_;
+    } else {
+        if (!readTimestamp(timestamp)) return false;
+        if (mode_ == TS_VALUE_FIXED) {
+            int32_t scaled;
+            if (!readFixed(scaled)) return false;
+            valueBits = (uint32_t)scaled;
+        } else if (!readXor(valueBits)) {
+            return false;
+        }
+    }
+
+    value = mode_ == TS_VALUE_FIXED ? (float)(int32_t)valueBits / POW10[decimals_] : bitsFloat(valueBits);
+    index_++;
+    return true;
+}
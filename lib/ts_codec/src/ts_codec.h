@@ -0,0 +1,119 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+// =====================
+// Time-series codec for (timestamp, value) samples
+// =====================
+// Gorilla-style bit-packed block: timestamps are stored as delta-of-delta,
+// values either as XOR against the previous float (TS_VALUE_XOR) or as a
+// delta of fixed-point integers (TS_VALUE_FIXED, value * 10^decimals). A
+// block of regularly sampled DHT11 readings costs a few bits per sample
+// instead of a float plus an ISO-8601 string.
+//
+// Block layout (bits are packed MSB first):
+//   byte 0   version (high nibble) | value mode (low nibble)
+//   byte 1   decimals (fixed-point mode only)
+//   byte 2-3 sample count, little-endian
+//   bits...  first timestamp (32) and value (32), then per sample:
+//            timestamp delta-of-delta bucket + value code
+//
+// Timestamps are uint32 in whatever unit the caller uses (e.g. Unix seconds
+// or milliseconds since boot); they must not decrease.
+
+#define TS_CODEC_VERSION 1
+#define TS_CODEC_HEADER_SIZE 4
+#define TS_CODEC_MAX_SAMPLES 0xFFFF
+
+enum TsValueMode : uint8_t {
+    TS_VALUE_XOR = 0,   // lossless for any float
+    TS_VALUE_FIXED = 1, // rounds to `decimals` places; best for sensor readings
+};
+
+// Append-only encoder writing into a caller-provided buffer. Memory use is
+// the buffer plus this object; nothing is allocated. The type is trivial (no
+// constructor, no owned memory) so it can be kept in RTC memory across deep
+// sleep together with its buffer: a constructor would make the compiler
+// reset it on every boot. Call begin() before append(); a value-initialized
+// encoder (TsEncoder enc{}) rejects appends.
+class TsEncoder {
+public:
+    // Start a new, empty block in buf. Returns false if cap cannot hold the
+    // header or decimals is out of range (fixed-point mode allows 0..6).
+    bool begin(uint8_t* buf, size_t cap, TsValueMode mode, uint8_t decimals = 1);
+
+    // Append one sample. Returns false (leaving the block unchanged) if the
+    // buffer is full, the timestamp goes backwards, the count limit is hit,
+    // or the value is not representable (NaN/out of range in fixed-point mode).
+    bool append(uint32_t timestamp, float value);
+
+    size_t count() const { return count_; }
+
+    // Bytes used so far, including the header; the block is always decodable.
+    size_t size() const { return (bitPos_ + 7) / 8; }
+
+    const uint8_t* data() const { return buf_; }
+
+    // Bits spent per sample so far (header included).
+    float bitsPerSample() const { return count_ ? (float)bitPos_ / (float)count_ : 0.0f; }
+
+private:
+    bool writeBits(uint64_t value, uint8_t bits);
+    bool writeTimestamp(uint32_t timestamp);
+    bool writeXor(uint32_t bits);
+    bool writeFixed(int32_t scaled);
+
+    uint8_t* buf_;
+    uint32_t cap_;
+    uint32_t bitPos_;
+    uint16_t count_;
+    uint8_t mode_;
+    uint8_t decimals_;
+    uint32_t prevTimestamp_;
+    int64_t prevDelta_;
+    uint32_t prevValueBits_;   // XOR: raw float bits, FIXED: scaled integer
+    uint8_t prevLeading_;
+    uint8_t prevTrailing_;
+};
+
+static_assert(std::is_trivial<TsEncoder>::value, "TsEncoder must stay trivial to live in RTC memory");
+
+// Iterator-style decoder over a complete block. Constant memory; the block
+// is read in place.
+class TsDecoder {
+public:
+    TsDecoder(const uint8_t* buf, size_t len);
+
+    // False if the header is malformed or from an unknown version.
+    bool valid() const { return valid_; }
+
+    size_t count() const { return count_; }
+    TsValueMode mode() const { return (TsValueMode)mode_; }
+    uint8_t decimals() const { return decimals_; }
+
+    // Produce the next sample. Returns false when all samples were read or
+    // the block is truncated.
+    bool next(uint32_t& timestamp, float& value);
+
+private:
+    bool readBits(uint8_t bits, uint64_t& out);
+    bool readTimestamp(uint32_t& timestamp);
+    bool readXor(uint32_t& bits);
+    bool readFixed(int32_t& scaled);
+
+    const uint8_t* buf_;
+    size_t len_;
+    size_t bitPos_;
+    bool valid_;
+    uint16_t count_;
+    uint16_t index_;
+    uint8_t mode_;
+    uint8_t decimals_;
+    uint32_t prevTimestamp_;
+    int64_t prevDelta_;
+    uint32_t prevValueBits_;
+    uint8_t prevLeading_;
+    uint8_t prevTrailing_;
+};
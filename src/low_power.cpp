@@ -0,0 +1,328 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <PubSubClient.h>
+#include <esp_sleep.h>
+#include <esp_system.h>
+#include <sys/time.h>
+#include <time.h>
+#include <type_traits>
+#include <duty_cycle.h>
+#include <ts_codec.h>
+
+#include <settings.h>
+#include <wifi_connect.h>
+#include <mqtt_connect.h>
+#include <dht_sensor.h>
+#include <rest_api.h>
+#include <low_power.h>
+
+// Worst-case bytes one sample can add to a series (37-bit timestamp + 37-bit value)
+static const size_t MAX_SAMPLE_BYTES = 10;
+
+// Config snapshot with fixed-size strings (String heap memory does not survive deep sleep)
+struct RtcConfig {
+    char status[32];
+    char tempSensorId[32];
+    char humSensorId[32];
+    uint32_t sendIntervalMs;
+    uint32_t flushIntervalMs;
+    bool publishTemperature;
+    bool publishHumidity;
+    bool lowPower;
+    bool deepSleep;
+    bool statusDirty;          // status changed but not published yet
+};
+
+// The config snapshot is also needed after ESP.restart() (leaving low-power
+// mode), which reloads RTC_DATA_ATTR variables; RTC_NOINIT_ATTR keeps it
+struct RtcConfigStore {
+    uint32_t magic;
+    bool saved;                // config below is valid and should be restored on the next boot
+    RtcConfig config;
+};
+
+// Sample buffers and schedule only have to survive deep sleep
+struct RtcState {
+    uint32_t magic;
+    bool scheduleStarted;      // duty/encoders below belong to a running low-power session
+    bool leavePending;         // always-on was requested while a batch was still unsent
+    DutyCycleState duty;
+    TsEncoder temperature;
+    TsEncoder humidity;
+    uint16_t temperaturePublished; // samples of the current batch already sent (retry resends the rest)
+    uint16_t humidityPublished;
+    uint8_t temperatureBuf[LOW_POWER_BUFFER_BYTES];
+    uint8_t humidityBuf[LOW_POWER_BUFFER_BYTES];
+};
+
+// Layout-dependent so a firmware update with a different struct never restores garbage
+static const uint32_t RTC_CONFIG_MAGIC = 0x4C504300u ^ (uint32_t)sizeof(RtcConfigStore);
+static const uint32_t RTC_STATE_MAGIC = 0x4C505700u ^ (uint32_t)sizeof(RtcState);
+
+// A constructor anywhere inside these would run on every boot (deep-sleep wake-ups included)
+// and wipe the retained content before lowPowerResume() sees it
+static_assert(std::is_trivially_default_constructible<RtcConfigStore>::value &&
+              std::is_trivially_copyable<RtcConfigStore>::value,
+              "RtcConfigStore must be plain data to live in RTC_NOINIT memory");
+static_assert(std::is_trivially_default_constructible<RtcState>::value,
+              "RtcState must have no dynamic initializer to survive deep sleep");
+
+RTC_NOINIT_ATTR static RtcConfigStore g_rtcConfig;
+RTC_DATA_ATTR static RtcState g_rtc;
+
+// Scheduler clock in ms (wraps). The system time is driven by the RTC timer,
+// so unlike millis() it keeps counting through deep sleep and the wake-up boot.
+static uint32_t lowPowerNowMs() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (uint32_t)((uint64_t)tv.tv_sec * 1000ULL + (uint64_t)tv.tv_usec / 1000ULL);
+}
+
+static void saveConfigToRtc() {
+    DeviceConfig& cfg = getDeviceConfig();
+    RtcConfig& rc = g_rtcConfig.config;
+    strlcpy(rc.status, cfg.status.c_str(), sizeof(rc.status));
+    strlcpy(rc.tempSensorId, cfg.tempSensorId.c_str(), sizeof(rc.tempSensorId));
+    strlcpy(rc.humSensorId, cfg.humSensorId.c_str(), sizeof(rc.humSensorId));
+    rc.sendIntervalMs = cfg.sendIntervalMs;
+    rc.flushIntervalMs = cfg.flushIntervalMs;
+    rc.publishTemperature = cfg.publishTemperature;
+    rc.publishHumidity = cfg.publishHumidity;
+    rc.lowPower = cfg.lowPower;
+    rc.deepSleep = cfg.deepSleep;
+    rc.statusDirty = cfg.statusDirty;
+    g_rtcConfig.saved = true;
+}
+
+static void restoreConfigFromRtc() {
+    DeviceConfig& cfg = getDeviceConfig();
+    const RtcConfig& rc = g_rtcConfig.config;
+    cfg.status = rc.status;
+    cfg.tempSensorId = rc.tempSensorId;
+    cfg.humSensorId = rc.humSensorId;
+    cfg.sendIntervalMs = rc.sendIntervalMs;
+    cfg.flushIntervalMs = rc.flushIntervalMs;
+    cfg.publishTemperature = rc.publishTemperature;
+    cfg.publishHumidity = rc.publishHumidity;
+    cfg.lowPower = rc.lowPower;
+    cfg.deepSleep = rc.deepSleep;
+    cfg.statusDirty = rc.statusDirty;
+}
+
+static DutyCycleConfig currentDutyConfig() {
+    DeviceConfig& cfg = getDeviceConfig();
+    DutyCycleConfig dc;
+    dc.sampleIntervalMs = cfg.sendIntervalMs < 1000 ? 1000 : cfg.sendIntervalMs; // DHT11 lower bound
+    dc.flushIntervalMs = cfg.flushIntervalMs;
+    dc.sleepMode = cfg.deepSleep ? SLEEP_DEEP : SLEEP_LIGHT;
+    return dc;
+}
+
+static void resetBuffers() {
+    g_rtc.temperature.begin(g_rtc.temperatureBuf, sizeof(g_rtc.temperatureBuf), TS_VALUE_FIXED, 1);
+    g_rtc.humidity.begin(g_rtc.humidityBuf, sizeof(g_rtc.humidityBuf), TS_VALUE_FIXED, 1);
+    g_rtc.temperaturePublished = 0;
+    g_rtc.humidityPublished = 0;
+}
+
+static bool buffersNearlyFull() {
+    return g_rtc.temperature.size() + MAX_SAMPLE_BYTES > sizeof(g_rtc.temperatureBuf) ||
+           g_rtc.humidity.size() + MAX_SAMPLE_BYTES > sizeof(g_rtc.humidityBuf);
+}
+
+static void radioOff() {
+    if (WiFi.getMode() != WIFI_OFF) {
+        WiFi.disconnect(true);
+        WiFi.mode(WIFI_OFF);
+    }
+}
+
+static void takeSample() {
+    // Samples are stamped with Unix time (seconds), which the ESP32 keeps across deep sleep
+    time_t now = time(nullptr);
+    float tC = NAN, h = NAN;
+    if (now < 100000) {
+        Serial.println("Low-power: time not set yet, sample skipped");
+        return;
+    }
+    if (!readDht11(tC, h)) {
+        return;
+    }
+    // Both series must stay index-aligned: check room in both before appending to either.
+    // With room for a worst-case sample, equal counts and non-NaN readings the
+    // humidity append cannot fail once the temperature append succeeded.
+    if (buffersNearlyFull()) {
+        Serial.println("Low-power: buffer full, sample dropped");
+        return;
+    }
+    if (g_rtc.temperature.append((uint32_t)now, tC)) {
+        g_rtc.humidity.append((uint32_t)now, h);
+    } else {
+        Serial.println("Low-power: sample rejected");
+    }
+}
+
+// Publish one buffered series as individual readings (same JSON schema as the always-on mode).
+// Skips the first `published` samples and advances it per sent reading, so a
+// flush that fails halfway resends only the remainder on the next attempt.
+static bool publishSeries(const TsEncoder& series, uint16_t& published, const char* topic,
+                          const String& sensorId, const char* unit) {
+    TsDecoder dec(series.data(), series.size());
+    uint32_t ts;
+    float value;
+    char iso[32];
+    char json[192];
+    uint16_t index = 0;
+    while (dec.next(ts, value)) {
+        if (index++ < published) {
+            continue;
+        }
+        time_t t = (time_t)ts;
+        struct tm* tmInfo = gmtime(&t);
+        if (!tmInfo || strftime(iso, sizeof(iso), "%Y-%m-%dT%H:%M:%SZ", tmInfo) == 0) {
+            iso[0] = '\0';
+        }
+        snprintf(json, sizeof(json),
+                 "{\"timestamp\":\"%s\",\"sensor_id\":\"%s\",\"value\":%.1f,\"unit\":\"%s\",\"status\":\"ok\"}",
+                 iso, sensorId.c_str(), value, unit);
+        if (!getMqttClient().publish(topic, json)) {
+            return false;
+        }
+        published++;
+        mqttLoop();
+    }
+    return true;
+}
+
+// Connect, upload the batch, fetch retained config and turn the radio off again
+static bool flushBatch() {
+    DeviceConfig& cfg = getDeviceConfig();
+    connectToWiFi(WIFI_SSID, WIFI_PASSWORD);
+    if (WiFi.status() != WL_CONNECTED) {
+        radioOff();
+        return false;
+    }
+
+    // Deep-sleep wake-ups skip setup(), so resync here or the RTC slow clock drifts for the
+    // whole battery life; the sync completes during the config wait below and the resulting
+    // clock step is absorbed by dutyCycleClampToClock()
+    configTime(0, 0, "pool.ntp.org", "time.nist.gov");
+
+    bool ok = connectToMqtt(MQTT_CLIENT_ID, MQTT_USERNAME, MQTT_PASSWORD);
+    if (ok) {
+        getMqttClient().subscribe(MQTT_TOPIC_CONFIG);
+        if (cfg.publishTemperature) {
+            ok = publishSeries(g_rtc.temperature, g_rtc.temperaturePublished, MQTT_TOPIC_TEMPERATURE_STATE,
+                               cfg.tempSensorId, SENSOR_UNIT) && ok;
+        }
+        if (cfg.publishHumidity) {
+            ok = publishSeries(g_rtc.humidity, g_rtc.humidityPublished, MQTT_TOPIC_HUMIDITY_STATE,
+                               cfg.humSensorId, HUM_SENSOR_UNIT) && ok;
+        }
+
+        // Give the broker time to deliver the retained config message (applied by the MQTT callback)
+        unsigned long start = millis();
+        while (millis() - start < LOW_POWER_CONFIG_WAIT_MS) {
+            mqttLoop();
+            delay(10);
+        }
+        // After the wait so a status change from the retained config goes out in this flush
+        if (cfg.statusDirty && getMqttClient().publish(MQTT_TOPIC_STATUS, cfg.status.c_str())) {
+            cfg.statusDirty = false;
+        }
+        getMqttClient().disconnect();
+    }
+
+    radioOff();
+    return ok;
+}
+
+static void startSchedule() {
+    if (getMqttClient().connected()) {
+        getMqttClient().publish(MQTT_TOPIC_STATUS, "low-power");
+    }
+    dutyCycleReset(g_rtc.duty, currentDutyConfig(), lowPowerNowMs());
+    resetBuffers();
+    g_rtc.leavePending = false;
+    g_rtc.scheduleStarted = true;
+}
+
+static void sleepUntilNextSample(const DutyCycleConfig& dc) {
+    // NTP sync during a flush may have stepped the clock
+    dutyCycleClampToClock(g_rtc.duty, dc, lowPowerNowMs());
+    uint32_t sleepMs = dutyCycleSleepMs(g_rtc.duty, lowPowerNowMs());
+    if (sleepMs == 0) {
+        return;
+    }
+
+    saveConfigToRtc();
+    radioOff();
+    Serial.flush();
+    esp_sleep_enable_timer_wakeup((uint64_t)sleepMs * 1000ULL);
+    if (dc.sleepMode == SLEEP_DEEP) {
+        esp_deep_sleep_start();
+    }
+    esp_light_sleep_start();
+}
+
+bool lowPowerResume() {
+    esp_reset_reason_t reason = esp_reset_reason();
+    bool warm = reason == ESP_RST_DEEPSLEEP || reason == ESP_RST_SW;
+    if (!warm || g_rtcConfig.magic != RTC_CONFIG_MAGIC) {
+        // Power-on or crash: RTC_NOINIT memory content is undefined
+        memset((void*)&g_rtcConfig, 0, sizeof(g_rtcConfig));
+        g_rtcConfig.magic = RTC_CONFIG_MAGIC;
+    } else if (g_rtcConfig.saved) {
+        restoreConfigFromRtc();
+    }
+
+    if (reason == ESP_RST_DEEPSLEEP && g_rtc.magic == RTC_STATE_MAGIC && g_rtc.scheduleStarted &&
+        getDeviceConfig().lowPower) {
+        return true;
+    }
+
+    // Regular boot into always-on mode; don't restore this snapshot again on later restarts
+    g_rtcConfig.saved = false;
+    memset((void*)&g_rtc, 0, sizeof(g_rtc));
+    g_rtc.magic = RTC_STATE_MAGIC;
+    return false;
+}
+
+void lowPowerLoop() {
+    DeviceConfig& cfg = getDeviceConfig();
+    DutyCycleConfig dc = currentDutyConfig();
+    if (!g_rtc.scheduleStarted) {
+        startSchedule();
+    }
+    dutyCycleClampToClock(g_rtc.duty, dc, lowPowerNowMs());
+
+    if (dutyCycleSampleDue(g_rtc.duty, lowPowerNowMs())) {
+        takeSample();
+        dutyCycleOnSample(g_rtc.duty, dc, lowPowerNowMs());
+    }
+
+    if (dutyCycleFlushDue(g_rtc.duty, lowPowerNowMs(), buffersNearlyFull())) {
+        bool ok = flushBatch();
+        if (ok) {
+            resetBuffers();
+        }
+        dutyCycleOnFlush(g_rtc.duty, dc, lowPowerNowMs(), ok);
+
+        if (!cfg.lowPower || g_rtc.leavePending) {
+            if (ok) {
+                // Switched back to always-on via MQTT config: reboot through the normal setup()
+                g_rtc.scheduleStarted = false;
+                cfg.lowPower = false;
+                saveConfigToRtc();
+                ESP.restart();
+            }
+            // The reboot resets the RTC buffers; stay in low-power mode until a flush drains them
+            cfg.lowPower = true;
+            g_rtc.leavePending = true;
+        }
+        // Interval changes apply to the next slot
+        dc = currentDutyConfig();
+    }
+
+    sleepUntilNextSample(dc);
+}
@@ -7,12 +7,27 @@
 #include <dht_sensor.h>
 #include <time.h>
 #include <rest_api.h>
+#include <ota_update.h>
+#include <low_power.h>
 
 // Wi-Fi helper functions are provided by wifi_connect.h / wifi_connect.cpp
 // MQTT helper functions are provided by mqtt_connect.h / mqtt_connect.cpp
 
 // Simple MQTT message callback: prints received payload and echoes ACK to status topic
 void onMqttMessage(char* topic, byte* payload, unsigned int length) {
+    // Firmware chunks are binary and frequent; hand them to the OTA receiver without echoing
+    if (handleOtaMqttMessage(topic, payload, length)) {
+        return;
+    }
+
+    // Retained config (same JSON as POST /config); the only way to reach a device in low-power mode
+    if (strcmp(topic, MQTT_TOPIC_CONFIG) == 0) {
+        if (!applyDeviceConfigJson((const char*)payload, length)) {
+            Serial.println("MQTT config: bad JSON ignored");
+        }
+        return;
+    }
+
     Serial.print("MQTT message on topic: ");
     Serial.println(topic);
 
@@ -40,16 +55,25 @@ static bool formatIso8601Utc(char* out, size_t outLen) {
 
 void setup() {
     Serial.begin(115200);
-    delay(1000);
 
     // Initialize DHT11 sensor (GPIO set in settings.h)
     setupDht11();
 
-    connectToWiFi(WIFI_SSID, WIFI_PASSWORD); // Initial Wi-Fi connection
-
-    // Start lightweight REST API to configure runtime behavior
+    // Seed runtime config and routes; the HTTP server itself starts once Wi-Fi is connected
     initRestApi();
 
+    // Setup MQTT client with broker settings and message callback (no network traffic yet)
+    setupMqttClient(MQTT_BROKER, MQTT_PORT);
+    getMqttClient().setCallback(onMqttMessage);
+
+    // Woken from low-power deep sleep: stay offline, loop() continues the duty cycle
+    if (lowPowerResume()) {
+        return;
+    }
+    delay(1000);
+
+    connectToWiFi(WIFI_SSID, WIFI_PASSWORD); // Initial Wi-Fi connection
+
     // Configure NTP time (UTC) so we can publish ISO8601 timestamps
     configTime(0, 0, "pool.ntp.org", "time.nist.gov");
     // Wait briefly for time to be set
@@ -59,23 +83,27 @@ void setup() {
         delay(100);
     }
 
-    // Setup MQTT client with broker settings
-    setupMqttClient(MQTT_BROKER, MQTT_PORT);
-
-    // Set message callback and connect
-    getMqttClient().setCallback(onMqttMessage);
     if (connectToMqtt(MQTT_CLIENT_ID, MQTT_USERNAME, MQTT_PASSWORD)) {
         // Subscribe to command topic and announce status
         getMqttClient().subscribe(MQTT_TOPIC_COMMAND);
+        getMqttClient().subscribe(MQTT_TOPIC_CONFIG);
+        getMqttClient().subscribe(MQTT_TOPIC_OTA, 1);
         getMqttClient().publish(MQTT_TOPIC_STATUS, "online");
     }
 }
 
 void loop() {
+    // Battery mode runs its own sample/flush/sleep cycle instead of the always-on loop below
+    if (getDeviceConfig().lowPower) {
+        lowPowerLoop();
+        return;
+    }
+
     handleWiFiReconnect();  // Ensure Wi-Fi stays connected
     handleMqttReconnect(MQTT_CLIENT_ID, MQTT_USERNAME, MQTT_PASSWORD); // Keep MQTT connected
     mqttLoop(); // Process incoming MQTT packets
     restApiLoop(); // Handle HTTP REST requests
+    otaLoop(); // Run a scheduled HTTP firmware update
 
     // Publish a heartbeat every 5 seconds when connected
     static unsigned long lastHeartbeat = 0;
@@ -3,6 +3,7 @@
 #include <WiFiClient.h>
 #include <PubSubClient.h>
 
+#include <settings.h>
 #include <mqtt_connect.h>
 
 // Internal globals
@@ -21,6 +22,7 @@ void setupMqttClient(const char* broker, uint16_t port) {
     g_brokerHost = broker ? broker : "";
     g_brokerPort = port;
     g_mqttClient.setServer(g_brokerHost.c_str(), g_brokerPort);
+    g_mqttClient.setBufferSize(MQTT_BUFFER_SIZE); // large enough for OTA chunks
 }
 
 bool connectToMqtt(const char* clientId, const char* username, const char* password) {
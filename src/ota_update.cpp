@@ -0,0 +1,200 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include <PubSubClient.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <ota_patch.h>
+
+#include <settings.h>
+#include <mqtt_connect.h>
+#include <ota_update.h>
+
+// Writes the reconstructed image into the partition the bootloader is not running from
+class InactivePartitionSink : public OtaPatchSink {
+public:
+    bool begin(uint32_t targetSize) override {
+        cancel();
+        partition_ = esp_ota_get_next_update_partition(nullptr);
+        if (!partition_ || targetSize > partition_->size) {
+            return false;
+        }
+        // Passing the real size erases only the sectors the image needs
+        return esp_ota_begin(partition_, targetSize, &handle_) == ESP_OK;
+    }
+
+    bool write(const uint8_t* data, size_t len) override {
+        return handle_ != 0 && esp_ota_write(handle_, data, len) == ESP_OK;
+    }
+
+    // Validate the written image and make it the next boot target
+    bool commit() {
+        if (handle_ == 0) return false;
+        esp_err_t err = esp_ota_end(handle_);
+        handle_ = 0;
+        return err == ESP_OK && esp_ota_set_boot_partition(partition_) == ESP_OK;
+    }
+
+    void cancel() {
+        if (handle_ != 0) {
+            esp_ota_abort(handle_);
+            handle_ = 0;
+        }
+    }
+
+private:
+    const esp_partition_t* partition_ = nullptr;
+    esp_ota_handle_t handle_ = 0;
+};
+
+// Delta patches copy unchanged regions from the firmware that is currently running
+class RunningPartitionBase : public OtaPatchBase {
+public:
+    bool read(uint32_t offset, uint8_t* out, size_t len) override {
+        const esp_partition_t* running = esp_ota_get_running_partition();
+        if (!running || offset + len > running->size) {
+            return false;
+        }
+        return esp_partition_read(running, offset, out, len) == ESP_OK;
+    }
+};
+
+// Internal state; the applier's window/output buffers are the only per-update RAM
+static InactivePartitionSink g_sink;
+static RunningPartitionBase g_base;
+static OtaPatchApplier g_applier(g_sink, &g_base);
+
+static bool g_active = false;
+static bool g_httpRunning = false; // MQTT chunks must not restart the applier mid-download
+static uint32_t g_mqttNextOffset = 0;
+static String g_pendingUrl;
+
+static void publishOtaStatus(const char* msg) {
+    Serial.print("OTA: ");
+    Serial.println(msg);
+    if (getMqttClient().connected()) {
+        getMqttClient().publish(MQTT_TOPIC_OTA_STATUS, msg);
+    }
+}
+
+static void startOta() {
+    g_sink.cancel();
+    g_applier.reset();
+    g_active = true;
+}
+
+// Completes or aborts the current update depending on the applier result
+static void finishOta(OtaPatchStatus st) {
+    g_active = false;
+    char msg[48];
+    if (st == OtaPatchStatus::Done && g_sink.commit()) {
+        snprintf(msg, sizeof(msg), "done %u bytes", (unsigned)g_applier.bytesWritten());
+        publishOtaStatus(msg);
+        getMqttClient().loop(); // push the status out before rebooting
+        delay(500);
+        ESP.restart();
+        return;
+    }
+
+    g_sink.cancel();
+    g_mqttNextOffset = 0; // the "next" reply to any further chunk tells the sender to restart
+    snprintf(msg, sizeof(msg), "error %s",
+             st == OtaPatchStatus::Ok || st == OtaPatchStatus::Done ? "incomplete" : otaPatchStatusName(st));
+    publishOtaStatus(msg);
+}
+
+static void runHttpOta(const String& url) {
+    Serial.print("OTA: Downloading ");
+    Serial.println(url);
+
+    HTTPClient http;
+    http.useHTTP10(true); // avoid chunked transfer encoding so the body can be streamed as-is
+    if (!http.begin(url)) {
+        publishOtaStatus("error bad-url");
+        return;
+    }
+    int code = http.GET();
+    if (code != HTTP_CODE_OK) {
+        char msg[32];
+        snprintf(msg, sizeof(msg), "error http %d", code);
+        publishOtaStatus(msg);
+        http.end();
+        return;
+    }
+
+    startOta();
+    g_httpRunning = true;
+    int remaining = http.getSize(); // -1 if the server did not send Content-Length
+    WiFiClient* stream = http.getStreamPtr();
+    uint8_t buf[512];
+    OtaPatchStatus st = OtaPatchStatus::Ok;
+    unsigned long lastData = millis();
+    while (st == OtaPatchStatus::Ok && (remaining > 0 || remaining == -1)) {
+        mqttLoop(); // keep the broker connection alive so the final status gets through
+        size_t avail = stream->available();
+        if (avail == 0) {
+            if (!http.connected() || millis() - lastData > OTA_HTTP_TIMEOUT_MS) break;
+            delay(1);
+            continue;
+        }
+        int n = stream->readBytes(buf, avail < sizeof(buf) ? avail : sizeof(buf));
+        if (n <= 0) continue;
+        lastData = millis();
+        st = g_applier.feed(buf, (size_t)n);
+        if (remaining > 0) remaining -= n;
+    }
+    http.end();
+    g_httpRunning = false;
+    finishOta(st);
+}
+
+void requestHttpOta(const char* url) {
+    g_pendingUrl = url ? url : "";
+}
+
+void otaLoop() {
+    if (g_pendingUrl.isEmpty() || WiFi.status() != WL_CONNECTED) {
+        return;
+    }
+    String url = g_pendingUrl;
+    g_pendingUrl = "";
+    runHttpOta(url);
+}
+
+bool handleOtaMqttMessage(const char* topic, const byte* payload, unsigned int length) {
+    if (strcmp(topic, MQTT_TOPIC_OTA) != 0) {
+        return false;
+    }
+    if (length < 4 || g_httpRunning) {
+        return true;
+    }
+
+    uint32_t offset = (uint32_t)payload[0] | ((uint32_t)payload[1] << 8) |
+                      ((uint32_t)payload[2] << 16) | ((uint32_t)payload[3] << 24);
+    if (offset == 0) {
+        startOta();
+        g_mqttNextOffset = 0;
+    }
+
+    char msg[32];
+    if (!g_active || offset != g_mqttNextOffset) {
+        // Lost or duplicated chunk: ask the sender to continue from what we have
+        snprintf(msg, sizeof(msg), "next %u", (unsigned)g_mqttNextOffset);
+        publishOtaStatus(msg);
+        return true;
+    }
+
+    OtaPatchStatus st = g_applier.feed(payload + 4, length - 4);
+    g_mqttNextOffset += length - 4;
+    if (st != OtaPatchStatus::Ok) {
+        finishOta(st);
+        return true;
+    }
+    snprintf(msg, sizeof(msg), "next %u", (unsigned)g_mqttNextOffset);
+    getMqttClient().publish(MQTT_TOPIC_OTA_STATUS, msg); // per-chunk ack for sender flow control
+    return true;
+}
+
+bool otaInProgress() {
+    return g_active;
+}
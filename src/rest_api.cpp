@@ -5,6 +5,7 @@
 
 #include <settings.h>
 #include <rest_api.h>
+#include <ota_update.h>
 
 // Internal server instance (port configurable via settings.h)
 static WebServer g_server(REST_API_PORT);
@@ -24,37 +25,21 @@ static void handleOptions() {
     g_server.send(204); // No Content
 }
 
-static void handleGetConfig() {
-    StaticJsonDocument<384> doc;
+// Serialize the effective config (shared by GET and POST responses)
+static void fillConfigDoc(JsonDocument& doc) {
     doc["status"] = g_cfg.status;
     doc["sendIntervalMs"] = g_cfg.sendIntervalMs;
     doc["publishTemperature"] = g_cfg.publishTemperature;
     doc["publishHumidity"] = g_cfg.publishHumidity;
     doc["tempSensorId"] = g_cfg.tempSensorId;
     doc["humSensorId"] = g_cfg.humSensorId;
-
-    String out;
-    serializeJson(doc, out);
-    sendCorsHeaders();
-    g_server.send(200, "application/json", out);
+    doc["lowPower"] = g_cfg.lowPower;
+    doc["flushIntervalMs"] = g_cfg.flushIntervalMs;
+    doc["deepSleep"] = g_cfg.deepSleep;
 }
 
-static void handlePostConfig() {
-    if (g_server.hasArg("plain") == false) {
-        sendCorsHeaders();
-        g_server.send(400, "application/json", "{\"error\":\"Missing body\"}");
-        return;
-    }
-
-    const String& body = g_server.arg("plain");
-    StaticJsonDocument<512> doc;
-    DeserializationError err = deserializeJson(doc, body);
-    if (err) {
-        sendCorsHeaders();
-        g_server.send(400, "application/json", String("{\"error\":\"Bad JSON: ") + err.c_str() + "\"}");
-        return;
-    }
-
+// Apply any subset of config fields; returns true if something changed
+static bool applyConfigDoc(const JsonDocument& doc) {
     bool changed = false;
     // Update fields if provided
     if (doc.containsKey("status") && doc["status"].is<const char*>()) {
@@ -87,20 +72,79 @@ static void handlePostConfig() {
         String v = doc["humSensorId"].as<String>();
         if (v.length() > 0 && v != g_cfg.humSensorId) { g_cfg.humSensorId = v; changed = true; }
     }
+    if (doc.containsKey("lowPower") && doc["lowPower"].is<bool>()) {
+        bool v = doc["lowPower"].as<bool>();
+        if (v != g_cfg.lowPower) { g_cfg.lowPower = v; changed = true; }
+    }
+    if (doc.containsKey("flushIntervalMs") && doc["flushIntervalMs"].is<uint32_t>()) {
+        uint32_t v = doc["flushIntervalMs"].as<uint32_t>();
+        // Each flush costs a Wi-Fi association; don't allow it to become near-continuous
+        if (v < LOW_POWER_MIN_FLUSH_INTERVAL_MS) v = LOW_POWER_MIN_FLUSH_INTERVAL_MS;
+        if (v != g_cfg.flushIntervalMs) { g_cfg.flushIntervalMs = v; changed = true; }
+    }
+    if (doc.containsKey("deepSleep") && doc["deepSleep"].is<bool>()) {
+        bool v = doc["deepSleep"].as<bool>();
+        if (v != g_cfg.deepSleep) { g_cfg.deepSleep = v; changed = true; }
+    }
+    return changed;
+}
+
+static void handleGetConfig() {
+    StaticJsonDocument<512> doc;
+    fillConfigDoc(doc);
+
+    String out;
+    serializeJson(doc, out);
+    sendCorsHeaders();
+    g_server.send(200, "application/json", out);
+}
+
+static void handlePostConfig() {
+    if (g_server.hasArg("plain") == false) {
+        sendCorsHeaders();
+        g_server.send(400, "application/json", "{\"error\":\"Missing body\"}");
+        return;
+    }
+
+    const String& body = g_server.arg("plain");
+    StaticJsonDocument<512> doc;
+    DeserializationError err = deserializeJson(doc, body);
+    if (err) {
+        sendCorsHeaders();
+        g_server.send(400, "application/json", String("{\"error\":\"Bad JSON: ") + err.c_str() + "\"}");
+        return;
+    }
+
+    applyConfigDoc(doc);
 
     // Respond with the effective config
-    StaticJsonDocument<384> outDoc;
-    outDoc["status"] = g_cfg.status;
-    outDoc["sendIntervalMs"] = g_cfg.sendIntervalMs;
-    outDoc["publishTemperature"] = g_cfg.publishTemperature;
-    outDoc["publishHumidity"] = g_cfg.publishHumidity;
-    outDoc["tempSensorId"] = g_cfg.tempSensorId;
-    outDoc["humSensorId"] = g_cfg.humSensorId;
+    StaticJsonDocument<512> outDoc;
+    fillConfigDoc(outDoc);
 
     String out;
     serializeJson(outDoc, out);
     sendCorsHeaders();
-    g_server.send(changed ? 200 : 200, "application/json", out);
+    g_server.send(200, "application/json", out);
+}
+
+static void handlePostOta() {
+    StaticJsonDocument<256> doc;
+    if (g_server.hasArg("plain") == false || deserializeJson(doc, g_server.arg("plain")) ||
+        !doc["url"].is<const char*>()) {
+        sendCorsHeaders();
+        g_server.send(400, "application/json", "{\"error\":\"Missing url\"}");
+        return;
+    }
+    if (otaInProgress()) {
+        sendCorsHeaders();
+        g_server.send(409, "application/json", "{\"error\":\"OTA already in progress\"}");
+        return;
+    }
+
+    // The download runs from otaLoop() after this response has been sent
+    requestHttpOta(doc["url"].as<const char*>());
+    sendCorsHeaders();
+    g_server.send(202, "application/json", "{\"ota\":\"scheduled\"}");
 }
 
 void initRestApi() {
@@ -112,11 +156,16 @@ void initRestApi() {
     g_cfg.publishHumidity = (REST_DEFAULT_PUBLISH_HUMIDITY != 0);
     g_cfg.tempSensorId = SENSOR_ID;
     g_cfg.humSensorId = HUM_SENSOR_ID;
+    g_cfg.lowPower = (LOW_POWER_DEFAULT_ENABLED != 0);
+    g_cfg.flushIntervalMs = LOW_POWER_DEFAULT_FLUSH_INTERVAL_MS;
+    g_cfg.deepSleep = (LOW_POWER_DEFAULT_DEEP_SLEEP != 0);
 
     // Routes
     g_server.on(REST_API_CONFIG_PATH, HTTP_OPTIONS, handleOptions);
     g_server.on(REST_API_CONFIG_PATH, HTTP_GET, handleGetConfig);
     g_server.on(REST_API_CONFIG_PATH, HTTP_POST, handlePostConfig);
+    g_server.on(REST_API_OTA_PATH, HTTP_OPTIONS, handleOptions);
+    g_server.on(REST_API_OTA_PATH, HTTP_POST, handlePostOta);
 
     // Defer starting the HTTP server until Wi‑Fi is connected
     if (WiFi.status() == WL_CONNECTED) {
@@ -152,6 +201,15 @@ void restApiLoop() {
     }
 }
 
+bool applyDeviceConfigJson(const char* json, size_t length) {
+    StaticJsonDocument<512> doc;
+    if (deserializeJson(doc, json, length)) {
+        return false;
+    }
+    applyConfigDoc(doc);
+    return true;
+}
+
 DeviceConfig& getDeviceConfig() {
     return g_cfg;
 }
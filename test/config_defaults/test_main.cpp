@@ -18,6 +18,9 @@ static void test_rest_config_defaults() {
     TEST_ASSERT_EQUAL((bool)(REST_DEFAULT_PUBLISH_HUMIDITY != 0), cfg.publishHumidity);
     TEST_ASSERT_EQUAL_STRING(SENSOR_ID, cfg.tempSensorId.c_str());
     TEST_ASSERT_EQUAL_STRING(HUM_SENSOR_ID, cfg.humSensorId.c_str());
+    TEST_ASSERT_EQUAL((bool)(LOW_POWER_DEFAULT_ENABLED != 0), cfg.lowPower);
+    TEST_ASSERT_EQUAL_UINT32(LOW_POWER_DEFAULT_FLUSH_INTERVAL_MS, cfg.flushIntervalMs);
+    TEST_ASSERT_EQUAL((bool)(LOW_POWER_DEFAULT_DEEP_SLEEP != 0), cfg.deepSleep);
     TEST_ASSERT_FALSE_MESSAGE(cfg.statusDirty, "statusDirty should be false after init");
 }
 
@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <unity.h>
+
+#include <duty_cycle.h>
+
+// Host-side tests for the low-power scheduler and energy model (pio test -e native).
+// A simulated millisecond clock drives the same functions the firmware uses.
+
+static const uint32_t HOUR_MS = 3600000u;
+static const uint32_t DAY_MS = 24u * HOUR_MS;
+
+void setUp() {}
+void tearDown() {}
+
+static DutyCycleConfig makeConfig(uint32_t sampleMs, uint32_t flushMs, uint8_t mode) {
+    DutyCycleConfig cfg;
+    cfg.sampleIntervalMs = sampleMs;
+    cfg.flushIntervalMs = flushMs;
+    cfg.sleepMode = mode;
+    return cfg;
+}
+
+static void test_flushes_every_n_samples_on_simulated_clock() {
+    DutyCycleConfig cfg = makeConfig(60000, 10 * 60000, SLEEP_DEEP);
+    DutyCycleState st;
+    uint32_t now = 1000;
+    dutyCycleReset(st, cfg, now);
+
+    int samples = 0;
+    int flushes = 0;
+    for (int wake = 0; wake < 30; ++wake) {
+        TEST_ASSERT_TRUE(dutyCycleSampleDue(st, now));
+        now += 40; // sensor read
+        dutyCycleOnSample(st, cfg, now);
+        samples++;
+        if (dutyCycleFlushDue(st, now, false)) {
+            // One flush per interval, i.e. every 10 samples; the first batch
+            // also holds the sample taken right at reset
+            TEST_ASSERT_EQUAL_UINT32(flushes == 0 ? 11 : 10, st.buffered);
+            now += 3000;
+            dutyCycleOnFlush(st, cfg, now, true);
+            TEST_ASSERT_EQUAL_UINT32(0, st.buffered);
+            flushes++;
+        }
+        now += dutyCycleSleepMs(st, now);
+    }
+    TEST_ASSERT_EQUAL_INT(30, samples);
+    TEST_ASSERT_EQUAL_INT(2, flushes);
+}
+
+static void test_sleep_compensates_awake_time() {
+    DutyCycleConfig cfg = makeConfig(10000, HOUR_MS, SLEEP_LIGHT);
+    DutyCycleState st;
+    dutyCycleReset(st, cfg, 0);
+
+    dutyCycleOnSample(st, cfg, 250);
+    // Sample cadence stays anchored to the schedule, not to when we finished
+    TEST_ASSERT_EQUAL_UINT32(10000 - 250, dutyCycleSleepMs(st, 250));
+    TEST_ASSERT_FALSE(dutyCycleSampleDue(st, 9999));
+    TEST_ASSERT_TRUE(dutyCycleSampleDue(st, 10000));
+
+    // A long flush that overruns several intervals resynchronizes instead of bursting
+    dutyCycleOnSample(st, cfg, 45000);
+    TEST_ASSERT_EQUAL_UINT32(55000, st.nextSampleMs);
+    TEST_ASSERT_EQUAL_UINT32(0, dutyCycleSleepMs(st, 60000));
+}
+
+static void test_full_buffer_flushes_early_but_not_after_failure() {
+    DutyCycleConfig cfg = makeConfig(1000, HOUR_MS, SLEEP_DEEP);
+    DutyCycleState st;
+    dutyCycleReset(st, cfg, 0);
+    dutyCycleOnSample(st, cfg, 0);
+
+    TEST_ASSERT_FALSE(dutyCycleFlushDue(st, 1000, false));
+    TEST_ASSERT_TRUE(dutyCycleFlushDue(st, 1000, true));
+
+    // Wi-Fi unavailable: keep the data, but don't retry on every sample
+    dutyCycleOnFlush(st, cfg, 1000, false);
+    TEST_ASSERT_EQUAL_UINT32(1, st.buffered);
+    TEST_ASSERT_FALSE(dutyCycleFlushDue(st, 2000, true));
+    TEST_ASSERT_TRUE(dutyCycleFlushDue(st, 2 * HOUR_MS, true));
+}
+
+static void test_clock_wraparound() {
+    DutyCycleConfig cfg = makeConfig(5000, 20000, SLEEP_DEEP);
+    DutyCycleState st;
+    uint32_t now = 0xFFFFF000u;
+    dutyCycleReset(st, cfg, now);
+    dutyCycleOnSample(st, cfg, now);
+
+    TEST_ASSERT_EQUAL_UINT32(5000, dutyCycleSleepMs(st, now));
+    now += 5000; // wraps past zero
+    TEST_ASSERT_TRUE(dutyCycleSampleDue(st, now));
+    TEST_ASSERT_FALSE(dutyCycleFlushDue(st, now, false));
+    TEST_ASSERT_TRUE(dutyCycleFlushDue(st, now + 15000, false));
+}
+
+static void test_clock_step_backwards_is_clamped() {
+    DutyCycleConfig cfg = makeConfig(60000, 10 * 60000, SLEEP_DEEP);
+    DutyCycleState st;
+    dutyCycleReset(st, cfg, 5000000);
+    dutyCycleOnSample(st, cfg, 5000000);
+
+    // NTP moved the clock back by an hour: without clamping we'd sleep for an hour
+    uint32_t now = 5000000 - HOUR_MS;
+    dutyCycleClampToClock(st, cfg, now);
+    TEST_ASSERT_EQUAL_UINT32(60000, dutyCycleSleepMs(st, now));
+    TEST_ASSERT_EQUAL_UINT32(now + 10 * 60000, st.nextFlushMs);
+
+    // A regular schedule is left untouched
+    DutyCycleState before = st;
+    dutyCycleClampToClock(st, cfg, now + 1000);
+    TEST_ASSERT_EQUAL_UINT32(before.nextSampleMs, st.nextSampleMs);
+    TEST_ASSERT_EQUAL_UINT32(before.nextFlushMs, st.nextFlushMs);
+}
+
+static void test_energy_model_orders_configurations() {
+    EnergyProfile p = defaultEsp32EnergyProfile();
+    DutyCycleSimResult deep = simulateDutyCycle(makeConfig(60000, 15 * 60000, SLEEP_DEEP), p, DAY_MS, 256);
+    DutyCycleSimResult light = simulateDutyCycle(makeConfig(60000, 15 * 60000, SLEEP_LIGHT), p, DAY_MS, 256);
+    DutyCycleSimResult chatty = simulateDutyCycle(makeConfig(60000, 60000, SLEEP_DEEP), p, DAY_MS, 256);
+    double alwaysOn = alwaysOnMahPerDay(p);
+
+    TEST_ASSERT_EQUAL_UINT32(1440, deep.samples);
+    TEST_ASSERT_EQUAL_UINT32(95, deep.flushes); // the 96th slot is the start of the next day
+    TEST_ASSERT_TRUE(deep.mahPerDay < light.mahPerDay);
+    TEST_ASSERT_TRUE(deep.mahPerDay < chatty.mahPerDay);
+    TEST_ASSERT_TRUE(chatty.mahPerDay < alwaysOn);
+    // Batching should cut consumption by more than an order of magnitude
+    TEST_ASSERT_TRUE(deep.mahPerDay * 10.0 < alwaysOn);
+}
+
+static void test_failed_flushes_are_retried_next_slot() {
+    EnergyProfile p = defaultEsp32EnergyProfile();
+    DutyCycleConfig cfg = makeConfig(60000, 10 * 60000, SLEEP_DEEP);
+    DutyCycleSimResult ok = simulateDutyCycle(cfg, p, DAY_MS, 256);
+    DutyCycleSimResult flaky = simulateDutyCycle(cfg, p, DAY_MS, 256, 3);
+
+    TEST_ASSERT_EQUAL_UINT32(ok.samples, flaky.samples);
+    TEST_ASSERT_EQUAL_UINT32(ok.flushes, flaky.flushes);
+    // Batches after a failure are larger, so radio time goes up slightly
+    TEST_ASSERT_TRUE(flaky.radioOnMs >= ok.radioOnMs);
+}
+
+static void test_report_mah_per_day() {
+    static const struct { uint32_t sampleMs; uint32_t flushMs; uint8_t mode; } configs[] = {
+        {2000, 60000, SLEEP_LIGHT},
+        {10000, 5 * 60000, SLEEP_LIGHT},
+        {10000, 5 * 60000, SLEEP_DEEP},
+        {60000, 15 * 60000, SLEEP_DEEP},
+        {60000, 60 * 60000, SLEEP_DEEP},
+        {300000, 6 * 60 * 60000, SLEEP_DEEP},
+    };
+    EnergyProfile p = defaultEsp32EnergyProfile();
+    printf("always-on: %.1f mAh/day\n", alwaysOnMahPerDay(p));
+    for (const auto& c : configs) {
+        DutyCycleSimResult r = simulateDutyCycle(makeConfig(c.sampleMs, c.flushMs, c.mode), p, DAY_MS, 256);
+        printf("sample %6u ms, flush %8u ms, %-5s: %7.2f mAh/day (%5u wakes, %4u flushes, radio %5u s)\n",
+               (unsigned)c.sampleMs, (unsigned)c.flushMs, c.mode == SLEEP_DEEP ? "deep" : "light",
+               r.mahPerDay, (unsigned)r.wakeups, (unsigned)r.flushes, (unsigned)(r.radioOnMs / 1000));
+        TEST_ASSERT_TRUE(r.mahPerDay > 0.0 && r.mahPerDay < alwaysOnMahPerDay(p));
+    }
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_flushes_every_n_samples_on_simulated_clock);
+    RUN_TEST(test_sleep_compensates_awake_time);
+    RUN_TEST(test_full_buffer_flushes_early_but_not_after_failure);
+    RUN_TEST(test_clock_wraparound);
+    RUN_TEST(test_clock_step_backwards_is_clamped);
+    RUN_TEST(test_energy_model_orders_configurations);
+    RUN_TEST(test_failed_flushes_are_retried_next_slot);
+    RUN_TEST(test_report_mah_per_day);
+    return UNITY_END();
+}
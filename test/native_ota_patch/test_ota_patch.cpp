@@ -0,0 +1,216 @@
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <unity.h>
+
+#include <ota_patch.h>
+#include <ota_patch_file.h>
+#include <ota_patch_gen.h>
+
+// Host-side tests for the OTA patch generator/applier (pio test -e native).
+// Partitions are emulated with temporary files via OtaFilePartition.
+
+static const uint32_t PARTITION_SIZE = 1024 * 1024;
+
+void setUp() {}
+void tearDown() {}
+
+// Deterministic firmware-like content: a small instruction vocabulary mixed
+// with pseudo-random immediates, similar in redundancy to real .bin images.
+static std::vector<uint8_t> makeImage(size_t len, uint32_t seed) {
+    static const uint8_t vocab[8][3] = {
+        {0x36, 0x41, 0x00}, {0x1d, 0xf0, 0x00}, {0x0c, 0x02, 0x00}, {0x81, 0x00, 0x00},
+        {0xe0, 0x08, 0x00}, {0x22, 0xa0, 0x00}, {0x06, 0x00, 0x00}, {0xc0, 0x20, 0x00},
+    };
+    std::vector<uint8_t> img;
+    uint32_t s = seed;
+    while (img.size() < len) {
+        s = s * 1103515245u + 12345u;
+        const uint8_t* ins = vocab[(s >> 16) & 7];
+        img.push_back(ins[0]);
+        img.push_back(ins[1]);
+        img.push_back((s >> 24) & 0x0F ? ins[2] : (uint8_t)(s >> 8));
+    }
+    img.resize(len);
+    return img;
+}
+
+// Simulates a rebuilt firmware: a few patched constants plus an inserted function
+static std::vector<uint8_t> makeNextVersion(const std::vector<uint8_t>& base) {
+    std::vector<uint8_t> next = base;
+    for (size_t off = 4096; off < next.size(); off += 40000) {
+        next[off] ^= 0x5A;
+        next[off + 1] += 3;
+    }
+    std::vector<uint8_t> inserted = makeImage(600, 777);
+    next.insert(next.begin() + (long)(next.size() / 2), inserted.begin(), inserted.end());
+    return next;
+}
+
+static FILE* makePartitionFile(const std::vector<uint8_t>& content) {
+    FILE* f = tmpfile();
+    TEST_ASSERT_NOT_NULL(f);
+    if (!content.empty()) {
+        TEST_ASSERT_EQUAL(content.size(), fwrite(content.data(), 1, content.size(), f));
+    }
+    return f;
+}
+
+static std::vector<uint8_t> readPartition(FILE* f, size_t len) {
+    std::vector<uint8_t> data(len);
+    fseek(f, 0, SEEK_SET);
+    TEST_ASSERT_EQUAL(len, fread(data.data(), 1, len, f));
+    return data;
+}
+
+// Feeds the patch in fixed-size chunks like an HTTP/MQTT transport would
+static OtaPatchStatus applyInChunks(OtaPatchApplier& applier, const std::vector<uint8_t>& patch, size_t chunk) {
+    OtaPatchStatus st = OtaPatchStatus::Ok;
+    for (size_t off = 0; off < patch.size() && st == OtaPatchStatus::Ok; off += chunk) {
+        size_t n = patch.size() - off < chunk ? patch.size() - off : chunk;
+        st = applier.feed(patch.data() + off, n);
+    }
+    return st;
+}
+
+static void test_sha256_known_vectors() {
+    static const uint8_t expectedAbc[32] = {
+        0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+        0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad,
+    };
+    static const uint8_t expectedEmpty[32] = {
+        0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14, 0x9a, 0xfb, 0xf4, 0xc8, 0x99, 0x6f, 0xb9, 0x24,
+        0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c, 0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55,
+    };
+    uint8_t digest[32];
+    Sha256 sha;
+    sha.update((const uint8_t*)"abc", 3);
+    sha.finish(digest);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expectedAbc, digest, 32);
+
+    sha.reset();
+    sha.finish(digest);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expectedEmpty, digest, 32);
+}
+
+static void test_full_image_roundtrip() {
+    std::vector<uint8_t> image = makeImage(300 * 1024, 1);
+    std::vector<uint8_t> patch = otaPatchCreate(image.data(), image.size());
+    TEST_ASSERT_LESS_THAN(image.size(), patch.size());
+
+    FILE* f = makePartitionFile({});
+    OtaFilePartition target(f, PARTITION_SIZE);
+    OtaPatchApplier applier(target, nullptr);
+    TEST_ASSERT_EQUAL((int)OtaPatchStatus::Done, (int)applyInChunks(applier, patch, 7));
+    TEST_ASSERT_FALSE(applier.isDelta());
+    TEST_ASSERT_EQUAL_UINT32(image.size(), target.bytesWritten());
+    TEST_ASSERT_TRUE(readPartition(f, image.size()) == image);
+    fclose(f);
+}
+
+static void test_delta_roundtrip_is_an_order_of_magnitude_smaller() {
+    std::vector<uint8_t> base = makeImage(512 * 1024, 2);
+    std::vector<uint8_t> next = makeNextVersion(base);
+    std::vector<uint8_t> full = otaPatchCreate(next.data(), next.size());
+    std::vector<uint8_t> patch = otaPatchCreate(next.data(), next.size(), base.data(), base.size());
+    printf("delta: image=%u full=%u delta=%u bytes\n",
+           (unsigned)next.size(), (unsigned)full.size(), (unsigned)patch.size());
+    TEST_ASSERT_LESS_THAN(full.size() / 10, patch.size());
+
+    FILE* running = makePartitionFile(base);
+    FILE* inactive = makePartitionFile({});
+    OtaFilePartition basePart(running, (uint32_t)base.size());
+    OtaFilePartition targetPart(inactive, PARTITION_SIZE);
+    OtaPatchApplier applier(targetPart, &basePart);
+    TEST_ASSERT_EQUAL((int)OtaPatchStatus::Done, (int)applyInChunks(applier, patch, 1024));
+    TEST_ASSERT_TRUE(applier.isDelta());
+    TEST_ASSERT_TRUE(readPartition(inactive, next.size()) == next);
+    fclose(running);
+    fclose(inactive);
+}
+
+static void test_delta_rejects_wrong_base() {
+    std::vector<uint8_t> base = makeImage(64 * 1024, 3);
+    std::vector<uint8_t> next = makeNextVersion(base);
+    std::vector<uint8_t> patch = otaPatchCreate(next.data(), next.size(), base.data(), base.size());
+
+    base[100] ^= 1; // device runs a different build than the patch expects
+    FILE* running = makePartitionFile(base);
+    FILE* inactive = makePartitionFile({});
+    OtaFilePartition basePart(running, (uint32_t)base.size());
+    OtaFilePartition targetPart(inactive, PARTITION_SIZE);
+    OtaPatchApplier applier(targetPart, &basePart);
+    TEST_ASSERT_EQUAL((int)OtaPatchStatus::BaseMismatch, (int)applyInChunks(applier, patch, 256));
+    TEST_ASSERT_EQUAL_UINT32(0, targetPart.writeCount());
+    fclose(running);
+    fclose(inactive);
+}
+
+static void test_corrupt_payload_fails_hash_check() {
+    std::vector<uint8_t> image = makeImage(32 * 1024, 4);
+    std::vector<uint8_t> patch = otaPatchCreate(image.data(), image.size());
+
+    // First opcode is a literal; flip one of its payload bytes
+    TEST_ASSERT_EQUAL_UINT8(OTA_OP_LITERAL, patch[OTA_PATCH_HEADER_SIZE]);
+    patch[OTA_PATCH_HEADER_SIZE + 2] ^= 0xFF;
+
+    FILE* f = makePartitionFile({});
+    OtaFilePartition target(f, PARTITION_SIZE);
+    OtaPatchApplier applier(target, nullptr);
+    TEST_ASSERT_EQUAL((int)OtaPatchStatus::HashMismatch, (int)applyInChunks(applier, patch, 100));
+    fclose(f);
+}
+
+static void test_truncated_patch_is_not_done_and_reset_recovers() {
+    std::vector<uint8_t> image = makeImage(16 * 1024, 5);
+    std::vector<uint8_t> patch = otaPatchCreate(image.data(), image.size());
+    std::vector<uint8_t> truncated(patch.begin(), patch.begin() + (long)(patch.size() / 2));
+
+    FILE* f = makePartitionFile({});
+    OtaFilePartition target(f, PARTITION_SIZE);
+    OtaPatchApplier applier(target, nullptr);
+    TEST_ASSERT_EQUAL((int)OtaPatchStatus::Ok, (int)applyInChunks(applier, truncated, 64));
+
+    applier.reset();
+    TEST_ASSERT_EQUAL((int)OtaPatchStatus::Done, (int)applyInChunks(applier, patch, 64));
+    TEST_ASSERT_TRUE(readPartition(f, image.size()) == image);
+    fclose(f);
+}
+
+static void test_image_larger_than_partition_is_rejected() {
+    std::vector<uint8_t> image = makeImage(8 * 1024, 6);
+    std::vector<uint8_t> patch = otaPatchCreate(image.data(), image.size());
+
+    FILE* f = makePartitionFile({});
+    OtaFilePartition target(f, 4 * 1024);
+    OtaPatchApplier applier(target, nullptr);
+    TEST_ASSERT_EQUAL((int)OtaPatchStatus::WriteError, (int)applyInChunks(applier, patch, 512));
+    fclose(f);
+}
+
+static void test_bad_magic_is_rejected() {
+    std::vector<uint8_t> image = makeImage(1024, 7);
+    std::vector<uint8_t> patch = otaPatchCreate(image.data(), image.size());
+    patch[0] = 'X';
+
+    FILE* f = makePartitionFile({});
+    OtaFilePartition target(f, PARTITION_SIZE);
+    OtaPatchApplier applier(target, nullptr);
+    TEST_ASSERT_EQUAL((int)OtaPatchStatus::BadHeader, (int)applyInChunks(applier, patch, 512));
+    fclose(f);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_sha256_known_vectors);
+    RUN_TEST(test_full_image_roundtrip);
+    RUN_TEST(test_delta_roundtrip_is_an_order_of_magnitude_smaller);
+    RUN_TEST(test_delta_rejects_wrong_base);
+    RUN_TEST(test_corrupt_payload_fails_hash_check);
+    RUN_TEST(test_truncated_patch_is_not_done_and_reset_recovers);
+    RUN_TEST(test_image_larger_than_partition_is_rejected);
+    RUN_TEST(test_bad_magic_is_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,193 @@
+#include <math.h>
+#include <string.h>
+#include <unity.h>
+
+#include <ts_codec.h>
+
+// Host-side tests for the time-series codec (pio test -e native).
+
+void setUp() {}
+void tearDown() {}
+
+static uint8_t g_buf[4096];
+
+// DHT11-like trace: 2 s sampling with a few ms of jitter, slow drift in 0.1 °C
+// steps, and the occasional failed read leaving a gap.
+static void makeTrace(uint32_t* ts, float* values, size_t n) {
+    uint32_t t = 1700000000u;
+    int tenths = 215;
+    uint32_t s = 42;
+    for (size_t i = 0; i < n; ++i) {
+        s = s * 1103515245u + 12345u;
+        t += 2000 + ((s >> 16) % 7) - 3;
+        if ((s >> 8) % 50 == 0) t += 2000; // missed sample
+        if ((s >> 20) % 8 == 0) tenths += ((s >> 24) & 1) ? 1 : -1;
+        ts[i] = t;
+        values[i] = (float)tenths / 10.0f;
+    }
+}
+
+static void test_fixed_point_roundtrip_on_dht_trace() {
+    const size_t n = 500;
+    uint32_t ts[n];
+    float values[n];
+    makeTrace(ts, values, n);
+
+    TsEncoder enc;
+    TEST_ASSERT_TRUE(enc.begin(g_buf, sizeof(g_buf), TS_VALUE_FIXED, 1));
+    for (size_t i = 0; i < n; ++i) {
+        TEST_ASSERT_TRUE(enc.append(ts[i], values[i]));
+    }
+    TEST_ASSERT_EQUAL_UINT32(n, enc.count());
+    // A float plus an ISO-8601 string is 24 bytes; the codec must do far better
+    TEST_ASSERT_LESS_THAN(16.0f, enc.bitsPerSample());
+
+    TsDecoder dec(enc.data(), enc.size());
+    TEST_ASSERT_TRUE(dec.valid());
+    TEST_ASSERT_EQUAL_UINT32(n, dec.count());
+    uint32_t t;
+    float v;
+    for (size_t i = 0; i < n; ++i) {
+        TEST_ASSERT_TRUE(dec.next(t, v));
+        TEST_ASSERT_EQUAL_UINT32(ts[i], t);
+        TEST_ASSERT_EQUAL_FLOAT(values[i], v);
+    }
+    TEST_ASSERT_FALSE(dec.next(t, v));
+}
+
+static void test_xor_mode_is_lossless() {
+    const float values[] = {23.4f, 23.4f, 23.5f, -7.25f, 0.0f, 1e-30f, 3.4e38f, 23.5f, 1.0f / 3.0f, -0.0f};
+    const size_t n = sizeof(values) / sizeof(values[0]);
+
+    TsEncoder enc;
+    TEST_ASSERT_TRUE(enc.begin(g_buf, sizeof(g_buf), TS_VALUE_XOR));
+    for (size_t i = 0; i < n; ++i) {
+        TEST_ASSERT_TRUE(enc.append((uint32_t)(60 * i), values[i]));
+    }
+
+    TsDecoder dec(enc.data(), enc.size());
+    uint32_t t;
+    float v;
+    for (size_t i = 0; i < n; ++i) {
+        TEST_ASSERT_TRUE(dec.next(t, v));
+        TEST_ASSERT_EQUAL_UINT32(60 * i, t);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY((const uint8_t*)&values[i], (const uint8_t*)&v, sizeof(float));
+    }
+}
+
+static void test_timestamp_buckets_and_extremes() {
+    const uint32_t ts[] = {0, 0, 1, 100, 200, 300, 1000, 5000, 5000, 0x7FFFFFFFu, 0xFFFFFFF0u, 0xFFFFFFFFu};
+    const size_t n = sizeof(ts) / sizeof(ts[0]);
+
+    TsEncoder enc;
+    TEST_ASSERT_TRUE(enc.begin(g_buf, sizeof(g_buf), TS_VALUE_FIXED, 0));
+    for (size_t i = 0; i < n; ++i) {
+        TEST_ASSERT_TRUE(enc.append(ts[i], (float)(i * 1000)));
+    }
+
+    TsDecoder dec(enc.data(), enc.size());
+    uint32_t t;
+    float v;
+    for (size_t i = 0; i < n; ++i) {
+        TEST_ASSERT_TRUE(dec.next(t, v));
+        TEST_ASSERT_EQUAL_UINT32(ts[i], t);
+        TEST_ASSERT_EQUAL_FLOAT((float)(i * 1000), v);
+    }
+}
+
+static void test_full_buffer_rejects_sample_and_keeps_block_intact() {
+    uint8_t small[16];
+    TsEncoder enc;
+    TEST_ASSERT_TRUE(enc.begin(small, sizeof(small), TS_VALUE_XOR));
+
+    uint32_t t = 1000;
+    size_t accepted = 0;
+    while (enc.append(t, 20.0f + (float)accepted * 1.37f)) {
+        t += 2;
+        accepted++;
+    }
+    TEST_ASSERT_GREATER_THAN(0, accepted);
+    size_t sizeBefore = enc.size();
+    TEST_ASSERT_FALSE(enc.append(t, 99.9f));
+    TEST_ASSERT_EQUAL_UINT32(sizeBefore, enc.size());
+    TEST_ASSERT_EQUAL_UINT32(accepted, enc.count());
+
+    TsDecoder dec(enc.data(), enc.size());
+    uint32_t outT;
+    float v;
+    for (size_t i = 0; i < accepted; ++i) {
+        TEST_ASSERT_TRUE(dec.next(outT, v));
+        TEST_ASSERT_EQUAL_UINT32(1000 + 2 * i, outT);
+    }
+    TEST_ASSERT_FALSE(dec.next(outT, v));
+}
+
+static void test_invalid_samples_are_rejected() {
+    TsEncoder enc;
+    TEST_ASSERT_TRUE(enc.begin(g_buf, sizeof(g_buf), TS_VALUE_FIXED, 1));
+    TEST_ASSERT_TRUE(enc.append(100, 21.0f));
+    TEST_ASSERT_FALSE(enc.append(99, 21.0f));   // time going backwards
+    TEST_ASSERT_FALSE(enc.append(101, NAN));    // failed sensor read
+    TEST_ASSERT_FALSE(enc.append(101, 1e12f));  // does not fit fixed-point range
+    TEST_ASSERT_EQUAL_UINT32(1, enc.count());
+
+    TEST_ASSERT_FALSE(enc.begin(g_buf, sizeof(g_buf), TS_VALUE_FIXED, 9));
+    TEST_ASSERT_FALSE(enc.begin(g_buf, 2, TS_VALUE_XOR));
+}
+
+static void test_decoder_rejects_bad_or_truncated_blocks() {
+    TsEncoder enc;
+    TEST_ASSERT_TRUE(enc.begin(g_buf, sizeof(g_buf), TS_VALUE_XOR));
+    for (uint32_t i = 0; i < 50; ++i) {
+        TEST_ASSERT_TRUE(enc.append(i * 10, (float)i * 0.77f));
+    }
+
+    // Truncated: decoding stops early instead of reading past the end
+    TsDecoder truncated(enc.data(), enc.size() / 2);
+    TEST_ASSERT_TRUE(truncated.valid());
+    uint32_t t;
+    float v;
+    size_t decoded = 0;
+    while (truncated.next(t, v)) decoded++;
+    TEST_ASSERT_LESS_THAN(50, decoded);
+
+    uint8_t bad[TS_CODEC_HEADER_SIZE] = {0x70, 0, 1, 0}; // unknown version
+    TsDecoder badDec(bad, sizeof(bad));
+    TEST_ASSERT_FALSE(badDec.valid());
+    TEST_ASSERT_FALSE(badDec.next(t, v));
+}
+
+static void test_append_before_begin_is_rejected() {
+    TsEncoder enc{};
+    TEST_ASSERT_FALSE(enc.append(1, 1.0f));
+    TEST_ASSERT_EQUAL_UINT32(0, enc.count());
+    TEST_ASSERT_EQUAL_UINT32(0, enc.size());
+}
+
+static void test_empty_block_decodes_to_nothing() {
+    TsEncoder enc;
+    TEST_ASSERT_TRUE(enc.begin(g_buf, sizeof(g_buf), TS_VALUE_FIXED, 1));
+    TEST_ASSERT_EQUAL_UINT32(TS_CODEC_HEADER_SIZE, enc.size());
+
+    TsDecoder dec(enc.data(), enc.size());
+    uint32_t t;
+    float v;
+    TEST_ASSERT_TRUE(dec.valid());
+    TEST_ASSERT_EQUAL_UINT32(0, dec.count());
+    TEST_ASSERT_FALSE(dec.next(t, v));
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_fixed_point_roundtrip_on_dht_trace);
+    RUN_TEST(test_xor_mode_is_lossless);
+    RUN_TEST(test_timestamp_buckets_and_extremes);
+    RUN_TEST(test_full_buffer_rejects_sample_and_keeps_block_intact);
+    RUN_TEST(test_invalid_samples_are_rejected);
+    RUN_TEST(test_decoder_rejects_bad_or_truncated_blocks);
+    RUN_TEST(test_append_before_begin_is_rejected);
+    RUN_TEST(test_empty_block_decodes_to_nothing);
+    return UNITY_END();
+}
@@ -0,0 +1,97 @@
+// Host-side command line tool to create and check OTA patches.
+//
+// Build (from project root):
+//   g++ -std=c++17 -O2 -Ilib/ota_patch/src tools/ota_patch.cpp lib/ota_patch/src/*.cpp -o ota_patch
+//
+// Usage:
+//   ota_patch create <new.bin> <out.iotp> [<running.bin>]   full image, or delta if running.bin is given
+//   ota_patch apply  <patch.iotp> <out.bin> [<running.bin>] reconstruct an image like the device would
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <ota_patch.h>
+#include <ota_patch_file.h>
+#include <ota_patch_gen.h>
+
+static bool readFile(const char* path, std::vector<uint8_t>& out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "ota_patch: cannot open %s\n", path);
+        return false;
+    }
+    uint8_t buf[4096];
+    size_t n;
+    out.clear();
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        out.insert(out.end(), buf, buf + n);
+    }
+    fclose(f);
+    return true;
+}
+
+static int createPatch(const char* targetPath, const char* outPath, const char* basePath) {
+    std::vector<uint8_t> target, base;
+    if (!readFile(targetPath, target)) return 1;
+    if (basePath && !readFile(basePath, base)) return 1;
+
+    std::vector<uint8_t> patch = basePath
+        ? otaPatchCreate(target.data(), target.size(), base.data(), base.size())
+        : otaPatchCreate(target.data(), target.size());
+
+    FILE* f = fopen(outPath, "wb");
+    if (!f || fwrite(patch.data(), 1, patch.size(), f) != patch.size()) {
+        fprintf(stderr, "ota_patch: cannot write %s\n", outPath);
+        if (f) fclose(f);
+        return 1;
+    }
+    fclose(f);
+    printf("%s patch: %zu -> %zu bytes (%.1f%%)\n", basePath ? "delta" : "full",
+           target.size(), patch.size(), 100.0 * (double)patch.size() / (double)(target.size() ? target.size() : 1));
+    return 0;
+}
+
+static int applyPatch(const char* patchPath, const char* outPath, const char* basePath) {
+    FILE* patchFile = fopen(patchPath, "rb");
+    FILE* outFile = fopen(outPath, "w+b");
+    FILE* baseFile = basePath ? fopen(basePath, "rb") : nullptr;
+    if (!patchFile || !outFile || (basePath && !baseFile)) {
+        fprintf(stderr, "ota_patch: cannot open input/output files\n");
+        return 1;
+    }
+
+    // 16 MiB is the largest ESP32 flash; the device enforces its real partition size
+    OtaFilePartition target(outFile, 16u * 1024u * 1024u);
+    OtaFilePartition base(baseFile, 16u * 1024u * 1024u);
+    OtaPatchApplier applier(target, baseFile ? &base : nullptr);
+
+    uint8_t buf[1024];
+    size_t n;
+    OtaPatchStatus st = OtaPatchStatus::Ok;
+    while (st == OtaPatchStatus::Ok && (n = fread(buf, 1, sizeof(buf), patchFile)) > 0) {
+        st = applier.feed(buf, n);
+    }
+    fclose(patchFile);
+    fclose(outFile);
+    if (baseFile) fclose(baseFile);
+
+    if (st != OtaPatchStatus::Done) {
+        fprintf(stderr, "ota_patch: apply failed: %s\n",
+                st == OtaPatchStatus::Ok ? "truncated patch" : otaPatchStatusName(st));
+        return 1;
+    }
+    printf("applied: %u bytes, hash verified\n", (unsigned)applier.bytesWritten());
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 4 && argc <= 5) {
+        const char* basePath = argc == 5 ? argv[4] : nullptr;
+        if (strcmp(argv[1], "create") == 0) return createPatch(argv[2], argv[3], basePath);
+        if (strcmp(argv[1], "apply") == 0) return applyPatch(argv[2], argv[3], basePath);
+    }
+    fprintf(stderr,
+            "usage: ota_patch create <new.bin> <out.iotp> [<running.bin>]\n"
+            "       ota_patch apply  <patch.iotp> <out.bin> [<running.bin>]\n");
+    return 2;
+}
@@ -0,0 +1,98 @@
+// Host-side benchmark for the time-series codec (lib/ts_codec) on synthetic
+// but realistic DHT11 traces. Reports bits/sample and encode/decode throughput.
+//
+// Build and run (from project root):
+//   g++ -std=c++17 -O2 -Ilib/ts_codec/src tools/ts_codec_bench.cpp lib/ts_codec/src/*.cpp -o ts_codec_bench
+//   ./ts_codec_bench
+#include <math.h>
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+
+#include <ts_codec.h>
+
+// Samples per block; roughly what fits an RTC-memory or MQTT batch
+static const size_t BLOCK_SAMPLES = 1024;
+static const int REPEATS = 2000;
+
+struct Trace {
+    const char* name;
+    std::vector<uint32_t> ts;
+    std::vector<float> values;
+    uint8_t decimals;
+};
+
+static uint32_t g_rng = 12345;
+static uint32_t nextRand() {
+    g_rng = g_rng * 1103515245u + 12345u;
+    return g_rng >> 8;
+}
+
+// DHT11 model: daily sine plus slow random walk, quantized to the sensor
+// resolution; timestamps at a fixed interval with scheduling jitter and
+// occasional failed reads (skipped samples).
+static Trace makeDhtTrace(const char* name, bool humidity, float resolution, uint8_t decimals,
+                          uint32_t intervalMs, bool unixSeconds) {
+    Trace tr;
+    tr.name = name;
+    tr.decimals = decimals;
+    double tMs = 0;
+    float walk = 0;
+    for (size_t i = 0; i < BLOCK_SAMPLES; ++i) {
+        tMs += intervalMs + (double)(nextRand() % 9) - 4.0;
+        if (nextRand() % 100 == 0) tMs += intervalMs; // failed read
+        walk += ((float)(nextRand() % 1000) / 1000.0f - 0.5f) * 0.05f;
+        double day = tMs / 86400000.0 * 2.0 * M_PI;
+        float v = humidity ? 45.0f + 8.0f * (float)sin(day) + walk * 4.0f
+                           : 22.0f + 3.0f * (float)sin(day) + walk;
+        tr.ts.push_back(unixSeconds ? 1760000000u + (uint32_t)(tMs / 1000.0) : (uint32_t)tMs);
+        tr.values.push_back(roundf(v / resolution) * resolution);
+    }
+    return tr;
+}
+
+static void run(const Trace& tr, TsValueMode mode) {
+    static uint8_t buf[16 * 1024];
+    TsEncoder enc;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < REPEATS; ++r) {
+        enc.begin(buf, sizeof(buf), mode, tr.decimals);
+        for (size_t i = 0; i < tr.ts.size(); ++i) {
+            enc.append(tr.ts[i], tr.values[i]);
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    volatile float sink = 0;
+    for (int r = 0; r < REPEATS; ++r) {
+        TsDecoder dec(enc.data(), enc.size());
+        uint32_t ts;
+        float v;
+        while (dec.next(ts, v)) sink = sink + v;
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    double samples = (double)tr.ts.size() * REPEATS;
+    double encS = std::chrono::duration<double>(t1 - t0).count();
+    double decS = std::chrono::duration<double>(t2 - t1).count();
+    printf("%-28s %-5s %7.2f bits/sample  %6zu B/%zu  enc %7.1f Msamples/s  dec %7.1f Msamples/s\n",
+           tr.name, mode == TS_VALUE_FIXED ? "fixed" : "xor", enc.bitsPerSample(), enc.size(),
+           enc.count(), samples / encS / 1e6, samples / decS / 1e6);
+}
+
+int main() {
+    std::vector<Trace> traces;
+    traces.push_back(makeDhtTrace("temp 1.0C, 2s, ms clock", false, 1.0f, 0, 2000, false));
+    traces.push_back(makeDhtTrace("temp 0.1C, 2s, ms clock", false, 0.1f, 1, 2000, false));
+    traces.push_back(makeDhtTrace("humidity 1%, 2s, ms clock", true, 1.0f, 0, 2000, false));
+    traces.push_back(makeDhtTrace("temp 0.1C, 60s, unix sec", false, 0.1f, 1, 60000, true));
+
+    // Reference: float + ISO-8601 string as built in main.cpp (4 + 20 bytes)
+    printf("baseline float+ISO8601: %d bits/sample\n\n", (4 + 20) * 8);
+    for (const Trace& tr : traces) {
+        run(tr, TS_VALUE_FIXED);
+        run(tr, TS_VALUE_XOR);
+    }
+    return 0;
+}
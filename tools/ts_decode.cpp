@@ -0,0 +1,56 @@
+// Host-side decoder for time-series codec blocks (lib/ts_codec), e.g. batches
+// captured from MQTT. Prints one "timestamp,value" CSV line per sample.
+//
+// Build (from project root):
+//   g++ -std=c++17 -O2 -Ilib/ts_codec/src tools/ts_decode.cpp lib/ts_codec/src/*.cpp -o ts_decode
+//
+// Usage:
+//   ts_decode <block.bin>      (use - to read from stdin)
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <ts_codec.h>
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: ts_decode <block.bin|->\n");
+        return 2;
+    }
+    FILE* f = strcmp(argv[1], "-") == 0 ? stdin : fopen(argv[1], "rb");
+    if (!f) {
+        fprintf(stderr, "ts_decode: cannot open %s\n", argv[1]);
+        return 1;
+    }
+    std::vector<uint8_t> block;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        block.insert(block.end(), buf, buf + n);
+    }
+    if (f != stdin) fclose(f);
+
+    TsDecoder dec(block.data(), block.size());
+    if (!dec.valid()) {
+        fprintf(stderr, "ts_decode: not a ts_codec block (or unsupported version)\n");
+        return 1;
+    }
+
+    uint32_t ts;
+    float value;
+    size_t decoded = 0;
+    printf("timestamp,value\n");
+    while (dec.next(ts, value)) {
+        if (dec.mode() == TS_VALUE_FIXED) {
+            printf("%u,%.*f\n", (unsigned)ts, (int)dec.decimals(), (double)value);
+        } else {
+            printf("%u,%.9g\n", (unsigned)ts, (double)value);
+        }
+        decoded++;
+    }
+    if (decoded != dec.count()) {
+        fprintf(stderr, "ts_decode: block truncated after %zu of %zu samples\n", decoded, dec.count());
+        return 1;
+    }
+    return 0;
+}